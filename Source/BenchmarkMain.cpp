@@ -0,0 +1,319 @@
+#include <JuceHeader.h>
+#include "GranularEngine.h"
+
+// Micro-benchmark of the grain hot path, driving GranularVoice and GranularEngine directly
+// Each case holds a steady grain count (2 s grains, density set so spawns replace
+// them one for one) on a synthetic noise source, then times whole blocks. Results
+// are ns per output sample and ns per grain-sample (one grain producing one output
+// sample), written as JSON so runs can be diffed between commits.
+
+namespace {
+    const char* const usage =
+        "[--full] [--filter=<text>] [--json=<file>] [--rate=48000] [--seconds=1] [--repeats=5]\n"
+        "    [--isa=scalar|sse2|avx2|neon] [--parallel]";
+    
+    // Every grain lasts this long, so each voice holds density * 100 grains once settled
+    constexpr float grainSizeParam = 1.0f;  // 2000 ms
+    constexpr double warmUpSeconds = 2.1;   // Past one grain length
+    constexpr double sourceSeconds = 10.0;
+    
+    struct Case {
+        bool engineLevel = true;    // Through the synthesiser, budget and MIDI, or one voice alone
+        int grains = 64;            // Across all voices
+        int voices = 4;
+        int blockSize = 256;
+        int quality = grainInterpolationCubic;
+        int channels = 2;
+        double pitchRatio = 1.5;    // 1.0 takes the direct path
+        GrainSampleFormat format = grainSampleFloat32;
+        
+        juce::String getName() const
+        {
+            static const char* const interpolationNames[] = { "linear", "cubic", "sinc" };
+            static const char* const formatNames[] = { "float", "int16", "half" };
+            return juce::String(engineLevel ? "engine" : "voice")
+                 + "/grains=" + juce::String(grains)
+                 + "/voices=" + juce::String(voices)
+                 + "/block=" + juce::String(blockSize)
+                 + "/" + interpolationNames[quality]
+                 + "/" + (channels == 1 ? "mono" : "stereo")
+                 + "/ratio=" + juce::String(pitchRatio, 2)
+                 + "/" + formatNames[format];
+        }
+        
+        // Each voice holds at most a pool of grains
+        bool isValid() const
+        {
+            const int perVoice = grains / voices;
+            return perVoice >= 1 && perVoice <= GranularVoice::grainPoolCapacity && grains % voices == 0
+                && (engineLevel || voices == 1);
+        }
+    };
+    
+    struct Result {
+        double nsPerSample = 0.0;
+        double nsPerGrainSample = 0.0;
+        double meanGrains = 0.0;
+    };
+    
+    // One source per channel count and format, built like a loaded sample
+    class SourceCache {
+    public:
+        explicit SourceCache(double rate) : sampleRate(rate) {}
+        
+        const GrainSource* get(int channels, GrainSampleFormat format)
+        {
+            auto& slot = sources[(size_t)(channels - 1)][(size_t)format];
+            if (slot == nullptr)
+            {
+                juce::AudioBuffer<float> noise (channels, (int)(sourceSeconds * sampleRate));
+                juce::Random random (1);
+                for (int ch = 0; ch < channels; ++ch)
+                    for (int i = 0; i < noise.getNumSamples(); ++i)
+                        noise.setSample(ch, i, random.nextFloat() * 2.0f - 1.0f);
+                
+                slot = new GrainSource(noise, sampleRate, 1, format);
+                slot->buildPyramid((size_t)128 * 1024 * 1024, [] { return false; });
+            }
+            return slot.get();
+        }
+    
+    private:
+        double sampleRate;
+        std::array<std::array<GrainSource::Ptr, numGrainSampleFormats>, 2> sources;
+    };
+    
+    GranularEngine::Params makeParams(const Case& c)
+    {
+        GranularEngine::Params params;
+        params.grainSize = grainSizeParam;
+        params.density = (float)(c.grains / c.voices) / 100.0f;
+        params.pitch = (float)(12.0 * std::log2(c.pitchRatio));
+        params.quality = (float)c.quality;
+        params.seed = 1.0f;
+        return params;
+    }
+    
+    // Renders blocks until seconds of audio have passed, returning the wall time and
+    // adding each block's grain count to grainSamples
+    template <typename RenderBlock, typename CountGrains>
+    double runFor(double seconds, double sampleRate, int blockSize, RenderBlock&& renderBlock, CountGrains&& countGrains, double& grainSamples)
+    {
+        const int numBlocks = juce::jmax(1, (int)(seconds * sampleRate) / blockSize);
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            renderBlock();
+            grainSamples += (double)countGrains() * blockSize;
+        }
+        return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    }
+    
+    // Median over repeats, after a warm-up that settles the grain count
+    template <typename RenderBlock, typename CountGrains>
+    Result measure(double sampleRate, int blockSize, double seconds, int repeats, RenderBlock&& renderBlock, CountGrains&& countGrains)
+    {
+        double ignored = 0.0;
+        runFor(warmUpSeconds, sampleRate, blockSize, renderBlock, countGrains, ignored);
+        
+        std::vector<Result> runs;
+        for (int r = 0; r < repeats; ++r)
+        {
+            double grainSamples = 0.0;
+            const double elapsed = runFor(seconds, sampleRate, blockSize, renderBlock, countGrains, grainSamples);
+            const double outputSamples = (double)(juce::jmax(1, (int)(seconds * sampleRate) / blockSize) * blockSize);
+            
+            Result run;
+            run.nsPerSample = elapsed * 1.0e9 / outputSamples;
+            run.meanGrains = grainSamples / outputSamples;
+            run.nsPerGrainSample = grainSamples > 0.0 ? elapsed * 1.0e9 / grainSamples : 0.0;
+            runs.push_back(run);
+        }
+        
+        std::sort(runs.begin(), runs.end(), [](const Result& a, const Result& b) { return a.nsPerSample < b.nsPerSample; });
+        return runs[runs.size() / 2];
+    }
+    
+    Result runCase(const Case& c, SourceCache& sources, double sampleRate, double seconds, int repeats, bool parallel)
+    {
+        const auto* source = sources.get(c.channels, c.format);
+        const auto params = makeParams(c);
+        juce::AudioBuffer<float> buffer (2, c.blockSize);
+        
+        if (!c.engineLevel)
+        {
+            GranularVoice voice;
+            voice.setParameters(params);
+            voice.setAudioSource(source);
+            voice.prepare(sampleRate, c.blockSize);
+            voice.startNote(60, 1.0f, nullptr, 8192);
+            
+            return measure(sampleRate, c.blockSize, seconds, repeats,
+                           [&] { buffer.clear(); voice.renderNextBlock(buffer, 0, c.blockSize); },
+                           [&] { return voice.getNumGrains(); });
+        }
+        
+        // No message loop here, so the workers have to start with prepare()
+        GranularEngine engine;
+        engine.setParallelRendering(parallel);
+        engine.prepare(sampleRate, c.blockSize, c.voices);
+        engine.setParams(params);
+        engine.setGrainBudget(0);
+        engine.updateSource(source);
+        
+        // One key per voice. The synthesiser retriggers a voice on a repeated note and
+        // channel, so past 16 voices the keys step up a semitone (a ratio about 6% higher).
+        juce::MidiBuffer midi;
+        for (int v = 0; v < c.voices; ++v)
+            midi.addEvent(juce::MidiMessage::noteOn(v % 16 + 1, 60 + v / 16, 1.0f), 0);
+        
+        return measure(sampleRate, c.blockSize, seconds, repeats,
+                       [&] { buffer.clear(); engine.render(buffer, midi); midi.clear(); },
+                       [&] { return engine.getNumActiveGrains(); });
+    }
+    
+    // The baseline varied one dimension at a time, or (full) every combination
+    std::vector<Case> makeCases(bool full)
+    {
+        const Case baseline;
+        const int grainCounts[] = { 1, 4, 16, 64, 128, 256 };
+        const int voiceCounts[] = { 1, 2, 4, 8, 16, 32 };
+        const int blockSizes[] = { 16, 64, 256, 1024, 2048 };
+        const int qualities[] = { grainInterpolationLinear, grainInterpolationCubic, grainInterpolationSinc };
+        const int channelCounts[] = { 1, 2 };
+        const double pitchRatios[] = { 0.5, 1.0, 1.5, 2.0 };
+        const GrainSampleFormat formats[] = { grainSampleFloat32, grainSampleInt16, grainSampleFloat16 };
+        
+        std::vector<Case> cases;
+        auto add = [&cases](const Case& c) {
+            if (c.isValid())
+                cases.push_back(c);
+        };
+        
+        // One voice alone, without the synthesiser or budget
+        for (int grains : grainCounts)
+        {
+            Case c = baseline;
+            c.engineLevel = false;
+            c.voices = 1;
+            c.grains = grains;
+            add(c);
+        }
+        
+        if (full)
+        {
+            for (int grains : grainCounts)
+                for (int voices : voiceCounts)
+                    for (int blockSize : blockSizes)
+                        for (int quality : qualities)
+                            for (int channels : channelCounts)
+                                for (double ratio : pitchRatios)
+                                    for (auto format : formats)
+                                        add({ true, grains, voices, blockSize, quality, channels, ratio, format });
+            return cases;
+        }
+        
+        for (int grains : grainCounts)     { Case c = baseline; c.grains = grains; add(c); }
+        for (int voices : voiceCounts)     { Case c = baseline; c.voices = voices; c.grains = juce::jmax(64, voices); add(c); }
+        for (int blockSize : blockSizes)   { Case c = baseline; c.blockSize = blockSize; add(c); }
+        for (int quality : qualities)      { Case c = baseline; c.quality = quality; add(c); }
+        for (int channels : channelCounts) { Case c = baseline; c.channels = channels; add(c); }
+        for (double ratio : pitchRatios)   { Case c = baseline; c.pitchRatio = ratio; add(c); }
+        for (auto format : formats)        { Case c = baseline; c.format = format; add(c); }
+        
+        // The sweeps share the baseline; run it once
+        std::vector<Case> unique;
+        juce::StringArray names;
+        for (const auto& c : cases)
+            if (names.addIfNotAlreadyThere(c.getName()))
+                unique.push_back(c);
+        return unique;
+    }
+    
+    GrainKernels::InstructionSet getInstructionSet(const juce::ArgumentList& args)
+    {
+        const auto name = args.getValueForOption("--isa");
+        if (name == "scalar") return GrainKernels::InstructionSet::scalar;
+        if (name == "sse2")   return GrainKernels::InstructionSet::sse2;
+        if (name == "avx2")   return GrainKernels::InstructionSet::avx2;
+        if (name == "neon")   return GrainKernels::InstructionSet::neon;
+        juce::ConsoleApplication::fail("Unknown instruction set " + name);
+        return GrainKernels::InstructionSet::scalar;
+    }
+    
+    void run(const juce::ArgumentList& args)
+    {
+        const double sampleRate = args.containsOption("--rate") ? args.getValueForOption("--rate").getDoubleValue() : 48000.0;
+        const double seconds = args.containsOption("--seconds") ? args.getValueForOption("--seconds").getDoubleValue() : 1.0;
+        const int repeats = args.containsOption("--repeats") ? args.getValueForOption("--repeats").getIntValue() : 5;
+        const bool parallel = args.containsOption("--parallel");
+        const auto filter = args.getValueForOption("--filter");
+        
+        if (sampleRate < 8000.0 || sampleRate > 384000.0)
+            juce::ConsoleApplication::fail("Sample rate out of range");
+        if (seconds <= 0.0 || repeats < 1)
+            juce::ConsoleApplication::fail("Nothing to measure");
+        
+        // Falls back to scalar when the CPU lacks the requested path
+        GrainKernels::initialise();
+        if (args.containsOption("--isa"))
+            GrainKernels::setInstructionSet(getInstructionSet(args));
+        const auto* kernelName = GrainKernels::getInstructionSetName(GrainKernels::getInstructionSet());
+        
+        juce::ScopedNoDenormals noDenormals;
+        SourceCache sources (sampleRate);
+        juce::Array<juce::var> results;
+        
+        for (const auto& c : makeCases(args.containsOption("--full")))
+        {
+            const auto name = c.getName();
+            if (filter.isNotEmpty() && !name.contains(filter))
+                continue;
+            
+            const auto result = runCase(c, sources, sampleRate, seconds, repeats, parallel);
+            std::cout << name.paddedRight(' ', 64) << juce::String(result.nsPerSample, 2).paddedLeft(' ', 10) << " ns/sample "
+                      << juce::String(result.nsPerGrainSample, 3).paddedLeft(' ', 9) << " ns/grain-sample "
+                      << juce::String(result.meanGrains, 1).paddedLeft(' ', 7) << " grains" << std::endl;
+            
+            auto* entry = new juce::DynamicObject();
+            entry->setProperty("name", name);
+            entry->setProperty("level", c.engineLevel ? "engine" : "voice");
+            entry->setProperty("grains", c.grains);
+            entry->setProperty("voices", c.voices);
+            entry->setProperty("blockSize", c.blockSize);
+            entry->setProperty("quality", c.quality);
+            entry->setProperty("channels", c.channels);
+            entry->setProperty("pitchRatio", c.pitchRatio);
+            entry->setProperty("format", (int)c.format);
+            entry->setProperty("measuredGrains", result.meanGrains);
+            entry->setProperty("nsPerSample", result.nsPerSample);
+            entry->setProperty("nsPerGrainSample", result.nsPerGrainSample);
+            results.add(juce::var(entry));
+        }
+        
+        if (args.containsOption("--json"))
+        {
+            auto* report = new juce::DynamicObject();
+            report->setProperty("kernels", kernelName);
+            report->setProperty("sampleRate", sampleRate);
+            report->setProperty("secondsPerRun", seconds);
+            report->setProperty("repeats", repeats);
+            report->setProperty("parallel", parallel);
+            report->setProperty("results", results);
+            
+            const auto file = args.getFileForOption("--json");
+            if (!file.replaceWithText(juce::JSON::toString(juce::var(report))))
+                juce::ConsoleApplication::fail("Can't write " + file.getFullPathName());
+        }
+        
+        std::cout << "Kernels: " << kernelName << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ConsoleApplication app;
+    app.addHelpCommand("--help|-h", juce::String("Usage: granular-bench ") + usage, false);
+    app.addDefaultCommand({ "", usage, "Times the grain hot path across a matrix of cases", {}, run });
+    return app.findAndRunCommand(argc, argv);
+}
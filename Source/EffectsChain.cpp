@@ -0,0 +1,80 @@
+#include "EffectsChain.h"
+
+void EffectsChain::prepare(double newSampleRate, int maximumBlockSize, float level)
+{
+    sampleRate = newSampleRate;
+    delay.prepare({ sampleRate, (juce::uint32) juce::jmax(1, maximumBlockSize), (juce::uint32) delayChannels });
+    {
+        const float delaySamples = (float) juce::jlimit(1, (int) sampleRate, (int) (delaySeconds * sampleRate));
+        delay.setDelay(delaySamples);
+    }
+    reverb.reset();
+    levelRamp.prepare(sampleRate, maximumBlockSize, 0.02, ParameterRamp::Shape::linear);
+    levelRamp.setCurrentAndTarget(level);
+}
+
+void EffectsChain::reset()
+{
+    delay.reset();
+    reverb.reset();
+}
+
+void EffectsChain::process(juce::AudioBuffer<float>& buffer, float level, float delayMix, float reverbMix)
+{
+    // Apply master level, ramped so automation doesn't step at block edges
+    levelRamp.setTarget(level);
+    for (int start = 0; start < buffer.getNumSamples();)
+    {
+        const int count = juce::jmin(buffer.getNumSamples() - start, levelRamp.getMaximumBlockSize());
+        const float* gains = levelRamp.process(count);
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            juce::FloatVectorOperations::multiply(buffer.getWritePointer(ch, start), gains, count);
+        start += count;
+    }
+    
+    auto totalCh = buffer.getNumChannels();
+    auto numSamples = buffer.getNumSamples();
+    
+    // Simple delay
+    if (delayMix > 0.0f)
+    {
+        // One line per channel; channels beyond the delay's are left dry
+        for (int ch = 0; ch < juce::jmin(totalCh, delayChannels); ++ch)
+        {
+            auto* d = buffer.getWritePointer(ch);
+            for (int i = 0; i < numSamples; ++i)
+            {
+                float delayed = delay.popSample(ch);
+                float inp = d[i];
+                delay.pushSample(ch, inp + delayed * delayFeedback);
+                d[i] = inp * (1.0f - delayMix) + delayed * delayMix;
+            }
+        }
+    }
+    
+    // Simple reverb
+    if (reverbMix > 0.0f)
+    {
+        reverbParams.wetLevel = reverbMix;
+        reverbParams.roomSize = 0.7f;
+        reverb.setParameters(reverbParams);
+        reverb.processStereo(buffer.getWritePointer(0),
+                           buffer.getNumChannels() > 1 ? buffer.getWritePointer(1) : buffer.getWritePointer(0),
+                           numSamples);
+    }
+}
+
+double EffectsChain::getTailSeconds(float delayMix, float reverbMix) const
+{
+    double seconds = 0.0;
+    
+    // Echoes every delay period, each delayFeedback quieter, until about -80 dB
+    if (delayMix > 0.0f && sampleRate > 0.0)
+        seconds += delay.getDelay() / sampleRate * std::ceil(std::log(1.0e-4) / std::log((double)delayFeedback));
+    
+    // The reverb follows the delay, so their tails add
+    if (reverbMix > 0.0f)
+        seconds += reverbTailSeconds;
+    
+    return seconds;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <JuceHeader.h>
+#include "ParameterRamp.h"
+
+// Master level, delay and reverb after the engine
+// Shared by the plugin processor and the offline renderer so both produce the
+// same output from the same engine render. Mix amounts are read per block;
+// the master level is ramped so automation doesn't step at block edges.
+class EffectsChain {
+public:
+    // Not real-time safe. Starts the level ramp settled at level.
+    void prepare(double sampleRate, int maximumBlockSize, float level);
+    
+    // Clears the delay line and the reverb tail
+    void reset();
+    
+    // In place, on one or two channels
+    void process(juce::AudioBuffer<float>& buffer, float level, float delayMix, float reverbMix);
+    
+    // How long the effects keep sounding after the input goes silent, to about -80 dB
+    double getTailSeconds(float delayMix, float reverbMix) const;
+
+private:
+    static constexpr int delayChannels = 2;
+    static constexpr double delaySeconds = 0.2;
+    static constexpr float delayFeedback = 0.4f;
+    static constexpr double reverbTailSeconds = 3.0; // Room size 0.7 to about -80 dB
+    
+    juce::Reverb reverb;
+    juce::Reverb::Parameters reverbParams;
+    juce::dsp::DelayLine<float> delay { 48000 }; // 1s max at 48k
+    ParameterRamp levelRamp;
+    double sampleRate = 0.0;
+};
@@ -0,0 +1,74 @@
+#pragma once
+#include "GranularEngine.h"
+#include "ParameterIDs.h"
+
+// Parameters that drive a GranularEngine::Params field directly, by ID
+// The processor binds these to its parameter tree; the offline renderer reads
+// them from a saved state. Quality is not listed: the processor overrides it
+// for offline bounces and the governor caps it.
+// defaultValue is the parameter tree's default (the processor asserts they
+// match). States saved before a parameter existed leave it out, and loading
+// them falls back to it, as the plugin does.
+struct EngineParameterField {
+    const char* id;
+    float GranularEngine::Params::* field;
+    float defaultValue;
+};
+
+inline const EngineParameterField engineParameterFields[] = {
+    // Core granular parameters
+    { Params::GrainSize,    &GranularEngine::Params::grainSize,    0.1f },
+    { Params::Density,      &GranularEngine::Params::density,      0.5f },
+    { Params::Texture,      &GranularEngine::Params::texture,      0.2f },
+    { Params::Pitch,        &GranularEngine::Params::pitch,        0.0f },
+    { Params::Position,     &GranularEngine::Params::position,     0.5f },
+    { Params::Reverse,      &GranularEngine::Params::reverse,      0.0f },
+    
+    // CPU-Optimized Ableton-style features
+    { Params::Scan,         &GranularEngine::Params::scan,         0.0f },
+    { Params::Spray,        &GranularEngine::Params::spray,        0.1f },
+    { Params::Jitter,       &GranularEngine::Params::jitter,       0.0f },
+    { Params::PitchJitter,  &GranularEngine::Params::pitchJitter,  0.0f },
+    { Params::GrainShape,   &GranularEngine::Params::grainShape,   0.0f },
+    { Params::LoopMode,     &GranularEngine::Params::loopMode,     0.0f },
+    { Params::Glide,        &GranularEngine::Params::glide,        0.0f },
+    
+    // Advanced parameters
+    { Params::StereoWidth,  &GranularEngine::Params::stereoWidth,  0.3f },
+    { Params::GrainPitch,   &GranularEngine::Params::grainPitch,   0.0f },
+    { Params::Freeze,       &GranularEngine::Params::freeze,       0.0f },
+    { Params::FilterCutoff, &GranularEngine::Params::filterCutoff, 1.0f },
+    { Params::FilterRes,    &GranularEngine::Params::filterRes,    0.0f },
+    { Params::FilterType,   &GranularEngine::Params::filterType,   0.0f },
+    { Params::FormantShift, &GranularEngine::Params::formantShift, 0.0f },
+    { Params::RandomSpread, &GranularEngine::Params::randomSpread, 0.0f },
+    { Params::GrainAmp,     &GranularEngine::Params::grainAmp,     0.0f },
+    
+    // Envelope
+    { Params::Attack,       &GranularEngine::Params::attack,       10.0f },
+    { Params::Decay,        &GranularEngine::Params::decay,        50.0f },
+    { Params::Sustain,      &GranularEngine::Params::sustain,      1.0f },
+    { Params::Release,      &GranularEngine::Params::release,      200.0f },
+    
+    // CPU-Optimized Enhanced Modulation System
+    { Params::LFORate,      &GranularEngine::Params::lfoRate,      1.0f },
+    { Params::LFOAmount,    &GranularEngine::Params::lfoAmount,    0.0f },
+    { Params::LFOTarget,    &GranularEngine::Params::lfoTarget,    0.0f },
+    { Params::LFOShape,     &GranularEngine::Params::lfoShape,     0.0f },
+    
+    // Second LFO (CPU-optimized)
+    { Params::LFO2Rate,     &GranularEngine::Params::lfo2Rate,     0.5f },
+    { Params::LFO2Amount,   &GranularEngine::Params::lfo2Amount,   0.0f },
+    { Params::LFO2Target,   &GranularEngine::Params::lfo2Target,   1.0f },
+    { Params::LFO2Shape,    &GranularEngine::Params::lfo2Shape,    0.0f },
+    
+    // New widening effects
+    { Params::ChorusAmount, &GranularEngine::Params::chorusAmount, 0.0f },
+    { Params::UnisonVoices, &GranularEngine::Params::unisonVoices, 1.0f },
+    
+    // Reproducible randomness
+    { Params::Seed,         &GranularEngine::Params::seed,         0.0f },
+};
+
+// Grain Budget parameter choices: most grains sounding across all voices (0 = no limit)
+inline constexpr std::array<int, 7> grainBudgetSizes { 32, 64, 96, 128, 192, 256, 0 };
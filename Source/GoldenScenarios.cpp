@@ -0,0 +1,140 @@
+#include "GoldenScenarios.h"
+
+namespace GoldenScenarios {
+
+namespace {
+    // The plugin's parameter defaults, which differ from the Params struct's
+    GranularEngine::Params makeBaseParams()
+    {
+        GranularEngine::Params params;
+        params.grainSize = 0.1f;
+        params.density = 0.5f;
+        params.texture = 0.2f;
+        params.position = 0.3f;     // Off centre, so reading backward lands elsewhere
+        params.spray = 0.1f;
+        params.stereoWidth = 0.3f;
+        params.lfoTarget = 0.0f;
+        params.lfo2Target = 1.0f;
+        params.quality = 1.0f;
+        params.seed = 1.0f;
+        return params;
+    }
+    
+    GoldenScenario makeVariant(const GoldenScenario& base, const juce::String& name, std::function<void(GranularEngine::Params&)> change)
+    {
+        GoldenScenario scenario = base;
+        scenario.name = name;
+        scenario.mustDifferFrom = base.name;
+        change(scenario.params);
+        return scenario;
+    }
+}
+
+std::vector<GoldenScenario> make()
+{
+    std::vector<GoldenScenario> scenarios;
+    
+    GoldenScenario notes;
+    notes.name = "notes";
+    notes.params = makeBaseParams();
+    scenarios.push_back(notes);
+    
+    // Every window shape against the default Hann
+    static const char* const shapeNames[] = { "triangle", "square", "gauss", "trapezoid", "tukey" };
+    for (int shape = 1; shape < (int)GrainWindows::numShapes; ++shape)
+        scenarios.push_back(makeVariant(notes, juce::String("shape-") + shapeNames[shape - 1],
+                                        [shape](auto& p) { p.grainShape = (float)shape; }));
+    
+    scenarios.push_back(makeVariant(notes, "loop-backward", [](auto& p) { p.loopMode = 1.0f; }));
+    
+    // PingPong only turns the scan around, which doesn't reach an end within the phrase
+    auto pingPong = makeVariant(notes, "loop-pingpong", [](auto& p) { p.loopMode = 2.0f; p.scan = 0.8f; });
+    pingPong.mustDifferFrom = {};
+    scenarios.push_back(pingPong);
+    
+    // LFO1 on each target; filter and amp aren't wired in the engine yet, so they
+    // are only held to their references
+    static const char* const targetNames[] = { "position", "pitch", "size", "filter", "amp" };
+    for (int target = 0; target < 5; ++target)
+    {
+        auto scenario = makeVariant(notes, juce::String("lfo-") + targetNames[target], [target](auto& p) {
+            p.lfoTarget = (float)target;
+            p.lfoAmount = 0.8f;
+            p.lfoRate = 0.3f;
+        });
+        if (target >= 3)
+            scenario.mustDifferFrom = {};
+        scenarios.push_back(scenario);
+    }
+    
+    auto unison = makeVariant(notes, "unison", [](auto& p) { p.unisonVoices = 4.0f; });
+    unison.cpuBudget = 0.2;
+    scenarios.push_back(unison);
+    
+    scenarios.push_back(makeVariant(notes, "chorus", [](auto& p) { p.chorusAmount = 0.7f; }));
+    
+    // The heaviest per-grain path
+    auto dense = makeVariant(notes, "dense-sinc", [](auto& p) {
+        p.density = 1.0f;
+        p.grainSize = 0.3f;
+        p.unisonVoices = 2.0f;
+        p.quality = 2.0f;
+    });
+    dense.cpuBudget = 0.5;
+    scenarios.push_back(dense);
+    
+    return scenarios;
+}
+
+juce::MidiMessageSequence makePhrase()
+{
+    juce::MidiMessageSequence events;
+    events.addEvent(juce::MidiMessage::noteOn(1, 60, 0.8f), 0.0);
+    events.addEvent(juce::MidiMessage::noteOn(1, 67, 0.6f), 0.4);
+    events.addEvent(juce::MidiMessage::noteOff(1, 60), 1.0);
+    events.addEvent(juce::MidiMessage::noteOff(1, 67), 1.3);
+    events.updateMatchedPairs();
+    return events;
+}
+
+juce::AudioBuffer<float> makeSource()
+{
+    constexpr double seconds = 4.0;
+    constexpr double startHz = 110.0, endHz = 1760.0;
+    
+    const int length = (int)(seconds * sampleRate);
+    juce::AudioBuffer<float> audio (2, length);
+    
+    // Phase of an exponential sweep; the right channel runs a fifth above
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        const double ratio = ch == 0 ? 1.0 : 1.5;
+        const double k = std::log(endHz / startHz) / seconds;
+        for (int i = 0; i < length; ++i)
+        {
+            const double t = (double)i / sampleRate;
+            const double phase = juce::MathConstants<double>::twoPi * startHz * ratio * (std::exp(k * t) - 1.0) / k;
+            const float level = 0.2f + 0.6f * (float)(t / seconds);
+            audio.setSample(ch, i, level * (float)std::sin(phase));
+        }
+    }
+    return audio;
+}
+
+float getMaxDifference(const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b)
+{
+    if (a.getNumChannels() != b.getNumChannels() || a.getNumSamples() != b.getNumSamples())
+        return std::numeric_limits<float>::infinity();
+    
+    float largest = 0.0f;
+    for (int ch = 0; ch < a.getNumChannels(); ++ch)
+    {
+        const float* x = a.getReadPointer(ch);
+        const float* y = b.getReadPointer(ch);
+        for (int i = 0; i < a.getNumSamples(); ++i)
+            largest = juce::jmax(largest, std::abs(x[i] - y[i]));
+    }
+    return largest;
+}
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <JuceHeader.h>
+#include "GranularEngine.h"
+
+// Fixed renders for the golden-audio regression check (granular-render --golden)
+// Every scenario plays the same two-note phrase over the same synthetic source
+// with seed 1, so its output repeats exactly on one machine and within rounding
+// across instruction sets. Each is compared against a stored reference WAV and
+// timed against a CPU budget; scenarios that change one parameter also name the
+// scenario they must not match, so a setting that silently does nothing fails.
+struct GoldenScenario {
+    juce::String name;
+    GranularEngine::Params params;
+    double cpuBudget = 0.1;         // Most render seconds per second of audio
+    juce::String mustDifferFrom;    // Empty when the output may legitimately match another
+};
+
+namespace GoldenScenarios {
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 256;
+    constexpr double tailSeconds = 0.5;     // After the last note off, fixed so lengths never drift
+    
+    std::vector<GoldenScenario> make();
+    
+    // Two overlapping notes, each switched on and off, timestamps in seconds
+    juce::MidiMessageSequence makePhrase();
+    
+    // A stereo exponential sweep with a rising level, so direction and position are audible
+    juce::AudioBuffer<float> makeSource();
+    
+    // Largest sample difference; infinite when the channel counts or lengths differ
+    float getMaxDifference(const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b);
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Caps the grains sounding across all voices of an engine
+// At the start of each block the engine culls the least audible grains down to
+// the limit and hands the remaining headroom out as spawn slots. Voices claim a
+// slot for every new grain, from whichever thread renders them, and drop the
+// grain when none are left, so no block renders more than the limit.
+// With multi-core rendering on, which voice gets the last slots depends on
+// thread timing, so parallel output matches serial only while under budget.
+class GrainBudget {
+public:
+    // Set from the audio thread between blocks; 0 means no limit
+    void setLimit(int maxGrains) { limit = juce::jmax(0, maxGrains); }
+    int getLimit() const { return limit; }
+    bool isLimited() const { return limit > 0; }
+    
+    // soundingGrains: grains left across all voices after culling
+    void beginBlock(int soundingGrains) {
+        slots.store(juce::jmax(0, limit - soundingGrains), std::memory_order_relaxed);
+    }
+    
+    // Lock-free; a refused grain counts as culled
+    bool tryAcquireSlot() {
+        if (!isLimited())
+            return true;
+            
+        int available = slots.load(std::memory_order_relaxed);
+        while (available > 0)
+            if (slots.compare_exchange_weak(available, available - 1, std::memory_order_relaxed))
+                return true;
+                
+        addCulled(1);
+        return false;
+    }
+    
+    // Gives back a slot whose grain didn't start
+    void releaseSlot() {
+        if (isLimited())
+            slots.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    void addCulled(int numGrains) { culled.fetch_add(numGrains, std::memory_order_relaxed); }
+    
+    // Running total since construction; safe to read from any thread
+    juce::int64 getNumCulled() const { return culled.load(std::memory_order_relaxed); }
+
+private:
+    int limit = 0;
+    std::atomic<int> slots { 0 };
+    std::atomic<juce::int64> culled { 0 };
+};
@@ -0,0 +1,310 @@
+#include "GrainKernels.h"
+#include "GrainKernelsSimd.h"
+#include "GrainSource.h"
+#include <cmath>
+
+namespace GrainKernels {
+
+namespace {
+    template <typename Interpolator, typename Sample, bool Reverse>
+    GrainKernel selectForDirection(bool stereo, bool windowed)
+    {
+        if (stereo)
+            return windowed ? &render<Interpolator, Sample, Reverse, true, true> : &render<Interpolator, Sample, Reverse, true, false>;
+        return windowed ? &render<Interpolator, Sample, Reverse, false, true> : &render<Interpolator, Sample, Reverse, false, false>;
+    }
+    
+    template <typename Interpolator, typename Sample>
+    GrainKernel selectForFormat(bool reverse, bool stereo, bool windowed)
+    {
+        return reverse ? selectForDirection<Interpolator, Sample, true>(stereo, windowed)
+                       : selectForDirection<Interpolator, Sample, false>(stereo, windowed);
+    }
+    
+    template <typename Interpolator>
+    GrainKernel selectFor(int format, bool reverse, bool stereo, bool windowed)
+    {
+        switch (format) {
+            case grainSampleInt16:   return selectForFormat<Interpolator, int16_t>(reverse, stereo, windowed);
+            case grainSampleFloat16: return selectForFormat<Interpolator, GrainHalf>(reverse, stereo, windowed);
+            default:                 return selectForFormat<Interpolator, float>(reverse, stereo, windowed);
+        }
+    }
+    
+    template <typename Interpolator>
+    constexpr bool fitsInGuards() {
+        return Interpolator::samplesBefore <= GrainSource::guardSamples && Interpolator::samplesAfter < GrainSource::guardSamples;
+    }
+    
+    static_assert(fitsInGuards<Linear>() && fitsInGuards<Cubic>() && fitsInGuards<Sinc>() && fitsInGuards<Direct>(), "Interpolator reads past the source guards");
+    
+    // Scalar reference kernels, also the fallback for anything a vector path lacks
+    const GrainKernel* getScalarKernels()
+    {
+        static const struct Table {
+            Table() {
+                for (int index = 0; index < numGrainKernels; ++index)
+                {
+                    const int format = index / grainKernelIndex(1, 0, false, false, false);
+                    const int interpolation = (index / grainKernelIndex(0, 1, false, false, false)) % numGrainInterpolations;
+                    const bool reverse = (index & grainKernelIndex(0, 0, true, false, false)) != 0;
+                    const bool stereo = (index & grainKernelIndex(0, 0, false, true, false)) != 0;
+                    const bool windowed = (index & grainKernelIndex(0, 0, false, false, true)) != 0;
+                    
+                    switch (interpolation) {
+                        case grainInterpolationCubic:  kernels[index] = selectFor<Cubic>(format, reverse, stereo, windowed); break;
+                        case grainInterpolationSinc:   kernels[index] = selectFor<Sinc>(format, reverse, stereo, windowed); break;
+                        case grainInterpolationDirect: kernels[index] = selectFor<Direct>(format, reverse, stereo, windowed); break;
+                        default:                       kernels[index] = selectFor<Linear>(format, reverse, stereo, windowed); break;
+                    }
+                }
+            }
+            GrainKernel kernels[numGrainKernels] {};
+        } table;
+        return table.kernels;
+    }
+    
+    // Modified Bessel function of the first kind, order 0 (for the Kaiser window)
+    double besselI0(double x)
+    {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 32; ++k)
+        {
+            const double t = x / (2.0 * k);
+            term *= t * t;
+            sum += term;
+            if (term < sum * 1.0e-12)
+                break;
+        }
+        return sum;
+    }
+    
+    // nullptr when the CPU or the build lacks the instruction set
+    const GrainKernel* getKernelsFor(InstructionSet set)
+    {
+        switch (set) {
+            case InstructionSet::sse2: return juce::SystemStats::hasSSE2() ? getSse2GrainKernels() : nullptr;
+            case InstructionSet::avx2: return (juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3()) ? getAvx2GrainKernels() : nullptr;
+            case InstructionSet::neon: return getNeonGrainKernels();
+            case InstructionSet::scalar:
+            default: return getScalarKernels();
+        }
+    }
+    
+    std::atomic<const GrainKernel*> activeKernels { nullptr };
+    std::atomic<InstructionSet> activeSet { InstructionSet::scalar };
+}
+
+void initialise()
+{
+    static const bool initialised = [] {
+        getSincTable();
+        
+        // Widest first
+        for (auto set : { InstructionSet::avx2, InstructionSet::sse2, InstructionSet::neon })
+        {
+            if (getKernelsFor(set) != nullptr)
+            {
+                setInstructionSet(set);
+                break;
+            }
+        }
+        
+        if (activeKernels.load() == nullptr)
+            setInstructionSet(InstructionSet::scalar);
+            
+       #if JUCE_DEBUG
+        // Vector output must track the scalar reference (granular-render --kernels checks every path)
+        jassert(measureDeviationFromScalar(getInstructionSet()) < maxDeviationFromScalar);
+       #endif
+        return true;
+    }();
+    
+    juce::ignoreUnused(initialised);
+}
+
+const float* getSincTable()
+{
+    // Built on first use, which initialise() forces from prepare()
+    static const struct Table {
+        Table() {
+            // Cutoff below Nyquist leaves room for the window's transition band
+            const double cutoff = 0.9;
+            const double beta = 8.0;
+            const double halfWidth = grainSincTaps / 2;
+            const double normaliser = besselI0(beta);
+            
+            for (int phase = 0; phase <= grainSincPhases; ++phase)
+            {
+                const double frac = (double)phase / (double)grainSincPhases;
+                float* taps = coefficients + phase * grainSincTaps;
+                double sum = 0.0;
+                
+                for (int k = 0; k < grainSincTaps; ++k)
+                {
+                    // Distance from the read position to source[index - samplesBefore + k]
+                    const double x = (double)(k - Sinc::samplesBefore) - frac;
+                    const double arg = juce::MathConstants<double>::pi * cutoff * x;
+                    const double sinc = std::abs(arg) < 1.0e-9 ? 1.0 : std::sin(arg) / arg;
+                    const double t = juce::jlimit(-1.0, 1.0, x / halfWidth);
+                    const double window = besselI0(beta * std::sqrt(1.0 - t * t)) / normaliser;
+                    const double h = cutoff * sinc * window;
+                    taps[k] = (float)h;
+                    sum += h;
+                }
+                
+                // Unity gain at DC for every phase
+                for (int k = 0; k < grainSincTaps; ++k)
+                    taps[k] = (float)((double)taps[k] / sum);
+            }
+        }
+        float coefficients[(grainSincPhases + 1) * grainSincTaps] {};
+    } table;
+    return table.coefficients;
+}
+
+InstructionSet getInstructionSet()
+{
+    return activeSet.load();
+}
+
+const char* getInstructionSetName(InstructionSet set)
+{
+    switch (set) {
+        case InstructionSet::sse2: return "SSE2";
+        case InstructionSet::avx2: return "AVX2/FMA";
+        case InstructionSet::neon: return "NEON";
+        case InstructionSet::scalar:
+        default: return "Scalar";
+    }
+}
+
+void setInstructionSet(InstructionSet set)
+{
+    auto* kernels = getKernelsFor(set);
+    if (kernels == nullptr)
+    {
+        set = InstructionSet::scalar;
+        kernels = getScalarKernels();
+    }
+    
+    activeSet.store(set);
+    activeKernels.store(kernels);
+}
+
+bool isAvailable(InstructionSet set)
+{
+    return getKernelsFor(set) != nullptr;
+}
+
+float measureDeviationFromScalar(InstructionSet set)
+{
+    const auto* kernels = getKernelsFor(set);
+    const auto* reference = getScalarKernels();
+    if (kernels == nullptr)
+        return 0.0f;
+        
+    // Deterministic noise source, with room for the widest interpolator either side
+    const int sourceLength = 4096;
+    const int guard = GrainSource::guardSamples;
+    const size_t numFrames = (size_t)(sourceLength + 2 * guard);
+    std::vector<float> mono (numFrames), stereo (numFrames * 2); // Stereo is interleaved, like GrainSource
+    juce::uint32 seed = 0x1234567u;
+    auto nextNoise = [&seed] {
+        seed = seed * 1664525u + 1013904223u;
+        return (float)(seed >> 8) / (float)(1u << 24) * 2.0f - 1.0f;
+    };
+    for (auto& sample : mono)
+        sample = nextNoise();
+    for (auto& sample : stereo)
+        sample = nextNoise();
+    
+    // The same noise in the compact formats
+    std::vector<int16_t> monoInt16 (mono.size()), stereoInt16 (stereo.size());
+    std::vector<GrainHalf> monoHalf (mono.size()), stereoHalf (stereo.size());
+    GrainSource::encodeSamples(mono.data(), monoInt16.data(), (int)mono.size());
+    GrainSource::encodeSamples(stereo.data(), stereoInt16.data(), (int)stereo.size());
+    GrainSource::encodeSamples(mono.data(), monoHalf.data(), (int)mono.size());
+    GrainSource::encodeSamples(stereo.data(), stereoHalf.data(), (int)stereo.size());
+    
+    const void* monoSources[numGrainSampleFormats] = { mono.data() + guard, monoInt16.data() + guard, monoHalf.data() + guard };
+    const void* stereoSources[numGrainSampleFormats] = { stereo.data() + 2 * guard, stereoInt16.data() + 2 * guard, stereoHalf.data() + 2 * guard };
+    
+    const int maxSamples = 67; // Odd length exercises the scalar tails
+    std::vector<float> expected ((size_t)maxSamples * 2), actual ((size_t)maxSamples * 2);
+    float deviation = 0.0f;
+    
+    for (int index = 0; index < numGrainKernels; ++index)
+    {
+        const int format = index / grainKernelIndex(1, 0, false, false, false);
+        const bool reverse = (index & grainKernelIndex(0, 0, true, false, false)) != 0;
+        const bool stereoKernel = (index & grainKernelIndex(0, 0, false, true, false)) != 0;
+        const bool direct = (index / grainKernelIndex(0, 1, false, false, false)) % numGrainInterpolations == grainInterpolationDirect;
+        
+        // Direct kernels only ever see unit steps from whole frames
+        for (float increment : { 0.25f, 0.5f, 1.0f, 1.37f, 2.0f, 3.9f })
+        {
+            if (direct && increment != 1.0f)
+                continue;
+                
+            for (int numSamples : { 1, 7, 8, 33, maxSamples })
+            {
+                const float startPosition = direct ? 3.0f : 0.31f;
+                
+                GrainSpan span;
+                span.source = stereoKernel ? stereoSources[format] : monoSources[format];
+                span.increment = increment;
+                span.position = reverse ? startPosition + increment * (float)numSamples : startPosition;
+                span.window = GrainWindows::getInstance().getTable(GrainWindows::hann);
+                span.phase = 0.1f;
+                span.phaseIncrement = 0.8f / (float)numSamples;
+                span.gainL = 0.7f;
+                span.gainR = 0.4f;
+                span.numSamples = numSamples;
+                span.sincTable = getSincTable();
+                
+                std::fill(expected.begin(), expected.end(), 0.25f);
+                std::fill(actual.begin(), actual.end(), 0.25f);
+                
+                span.mixL = expected.data();
+                span.mixR = expected.data() + maxSamples;
+                reference[index](span);
+                
+                span.mixL = actual.data();
+                span.mixR = actual.data() + maxSamples;
+                kernels[index](span);
+                
+                for (size_t i = 0; i < expected.size(); ++i)
+                    deviation = juce::jmax(deviation, std::abs(expected[i] - actual[i]));
+            }
+        }
+    }
+    
+    return deviation;
+}
+
+GrainKernel select(int shape, bool reverse, int numSourceChannels, GrainInterpolation interpolation, GrainSampleFormat format)
+{
+    const bool stereo = numSourceChannels > 1;
+    const bool windowed = shape != GrainWindows::square; // Square has no envelope
+    const int index = grainKernelIndex(juce::jlimit(0, numGrainSampleFormats - 1, (int)format),
+                                       juce::jlimit(0, numGrainInterpolations - 1, (int)interpolation), reverse, stereo, windowed);
+    
+    const auto* kernels = activeKernels.load(std::memory_order_relaxed);
+    if (kernels != nullptr && kernels[index] != nullptr)
+        return kernels[index];
+    return getScalarKernels()[index];
+}
+
+int spanLengthBeforeWrap(double position, double increment, bool reverse, int numSourceSamples, int maxSamples)
+{
+    const double p = position;
+    const double inc = juce::jmax(1.0e-6, increment);
+    
+    // Forward: every position stays below numSourceSamples; reverse: every position stays at or above 0
+    const double count = reverse ? std::floor(p / inc) + 1.0
+                                 : std::ceil(((double)numSourceSamples - p) / inc);
+    return (int)juce::jlimit(0.0, (double)maxSamples, count);
+}
+
+}
@@ -0,0 +1,149 @@
+#pragma once
+#include <JuceHeader.h>
+#include "GrainWindows.h"
+#include "GrainSpan.h"
+
+namespace GrainKernels {
+    // Interpolators are constructed once per span; samplesBefore/samplesAfter
+    // must fit in GrainSource::guardSamples. Sources are float, int16 or half,
+    // and Stride steps from one frame to the next (2 for interleaved stereo).
+    
+    // Linear interpolation between index and index + 1 (Draft quality)
+    struct Linear {
+        static constexpr int samplesBefore = 0;
+        static constexpr int samplesAfter = 1;
+        
+        explicit Linear(const GrainSpan&) {}
+        
+        template <int Stride, typename Sample>
+        float read(const Sample* source, int index, float frac) const {
+            const float s0 = grainSampleToFloat(source[index * Stride]);
+            return s0 + frac * (grainSampleToFloat(source[(index + 1) * Stride]) - s0);
+        }
+    };
+    
+    // 4-point, 3rd-order Hermite (Catmull-Rom) through index - 1 .. index + 2 (Live quality)
+    struct Cubic {
+        static constexpr int samplesBefore = 1;
+        static constexpr int samplesAfter = 2;
+        
+        explicit Cubic(const GrainSpan&) {}
+        
+        template <int Stride, typename Sample>
+        float read(const Sample* source, int index, float frac) const {
+            const float ym1 = grainSampleToFloat(source[(index - 1) * Stride]);
+            const float y0 = grainSampleToFloat(source[index * Stride]);
+            const float y1 = grainSampleToFloat(source[(index + 1) * Stride]);
+            const float y2 = grainSampleToFloat(source[(index + 2) * Stride]);
+            const float c1 = 0.5f * (y1 - ym1);
+            const float c2 = ym1 - 2.5f * y0 + 2.0f * y1 - 0.5f * y2;
+            const float c3 = 0.5f * (y2 - ym1) + 1.5f * (y0 - y1);
+            return ((c3 * frac + c2) * frac + c1) * frac + y0;
+        }
+    };
+    
+    // Windowed sinc from the polyphase table, interpolating between adjacent phases (Render quality)
+    struct Sinc {
+        static constexpr int samplesBefore = grainSincTaps / 2 - 1;
+        static constexpr int samplesAfter = grainSincTaps / 2;
+        
+        explicit Sinc(const GrainSpan& span) : table(span.sincTable) { jassert(table != nullptr); }
+        
+        template <int Stride, typename Sample>
+        float read(const Sample* source, int index, float frac) const {
+            const float phase = frac * (float)grainSincPhases;
+            const int row = (int)phase;
+            const float rowFrac = phase - (float)row;
+            const float* taps0 = table + row * grainSincTaps;
+            const float* taps1 = taps0 + grainSincTaps;
+            const Sample* samples = source + (index - samplesBefore) * Stride;
+            
+            float sum = 0.0f;
+            for (int k = 0; k < grainSincTaps; ++k)
+                sum += (taps0[k] + rowFrac * (taps1[k] - taps0[k])) * grainSampleToFloat(samples[k * Stride]);
+            return sum;
+        }
+        
+        const float* table;
+    };
+    
+    // The frame at index, for grains stepping exactly one frame per output sample
+    // from a whole-frame position (unpitched, source at the session rate)
+    struct Direct {
+        static constexpr int samplesBefore = 0;
+        static constexpr int samplesAfter = 0;
+        
+        explicit Direct(const GrainSpan&) {}
+        
+        template <int Stride, typename Sample>
+        float read(const Sample* source, int index, float) const {
+            return grainSampleToFloat(source[index * Stride]);
+        }
+    };
+    
+    // Branch-free grain renderer; all per-grain decisions are template parameters
+    template <typename Interpolator, typename Sample, bool Reverse, bool Stereo, bool Windowed>
+    void render(const GrainSpan& span) {
+        const Interpolator interpolator (span);
+        constexpr int stride = Stereo ? 2 : 1;
+        const Sample* JUCE_RESTRICT source = static_cast<const Sample*>(span.source);
+        float* JUCE_RESTRICT mixL = span.mixL;
+        float* JUCE_RESTRICT mixR = span.mixR;
+        
+        for (int i = 0; i < span.numSamples; ++i)
+        {
+            // Positions are computed, not accumulated, so rounding never walks out of the span
+            const float offset = (float)i * span.increment;
+            const float position = Reverse ? span.position - offset : span.position + offset;
+            const int index = (int)position;
+            const float frac = position - (float)index;
+            
+            const float envelopeValue = Windowed ? GrainWindows::lookup(span.window, span.phase + (float)i * span.phaseIncrement) : 1.0f;
+            const float sampleL = interpolator.template read<stride>(source, index, frac);
+            const float sampleR = Stereo ? interpolator.template read<stride>(source + 1, index, frac) : sampleL;
+            
+            mixL[i] += sampleL * envelopeValue * span.gainL;
+            mixR[i] += sampleR * envelopeValue * span.gainR;
+        }
+    }
+    
+    // Vector paths, chosen once from the CPU's capabilities
+    enum class InstructionSet {
+        scalar,
+        sse2,
+        avx2,
+        neon
+    };
+    
+    // Detects the CPU, selects the kernel tables and builds the sinc table; call from prepare()
+    void initialise();
+    
+    // Polyphase windowed-sinc coefficients (layout in GrainSpan.h)
+    const float* getSincTable();
+    
+    InstructionSet getInstructionSet();
+    const char* getInstructionSetName(InstructionSet set);
+    
+    // Forces a path (e.g. scalar as the reference); falls back to scalar if the CPU lacks it.
+    // Grains keep the kernel they were spawned with.
+    void setInstructionSet(InstructionSet set);
+    
+    // False when the CPU or the build lacks the instruction set
+    bool isAvailable(InstructionSet set);
+    
+    // Largest absolute difference between the given path and the scalar reference
+    // over a fixed set of synthetic spans; 0 for an unavailable path
+    float measureDeviationFromScalar(InstructionSet set);
+    
+    // Most a vector path may deviate (exact without FMA, within rounding with it)
+    constexpr float maxDeviationFromScalar = 1.0e-4f;
+    
+    // Picks the specialisation for a grain once, at spawn time
+    GrainKernel select(int shape, bool reverse, int numSourceChannels, GrainInterpolation interpolation,
+                       GrainSampleFormat format = grainSampleFloat32);
+    
+    // Number of samples from position (inside the source) that can be rendered before
+    // the grain leaves [0, numSourceSamples) and has to wrap. Reads just past the
+    // ends land in the source's guard samples.
+    int spanLengthBeforeWrap(double position, double increment, bool reverse, int numSourceSamples, int maxSamples);
+}
@@ -0,0 +1,128 @@
+#include "GrainKernelsSimd.h"
+
+// Built with AVX2/FMA code generation (see CMakeLists.txt); only called after a runtime CPU check
+#if defined(__AVX2__) && defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__))
+#include <immintrin.h>
+
+namespace {
+    struct Avx2Ops {
+        using Vec = __m256;
+        using Int = __m256i;
+        static constexpr int width = 8;
+        
+        static Vec set(float v) { return _mm256_set1_ps(v); }
+        static Vec iota() { return _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f); }
+        static Vec add(Vec a, Vec b) { return _mm256_add_ps(a, b); }
+        static Vec sub(Vec a, Vec b) { return _mm256_sub_ps(a, b); }
+        static Vec mul(Vec a, Vec b) { return _mm256_mul_ps(a, b); }
+        static Vec mulAdd(Vec a, Vec b, Vec c) { return _mm256_fmadd_ps(a, b, c); }
+        static Vec min(Vec a, Vec b) { return _mm256_min_ps(a, b); }
+        static Vec max(Vec a, Vec b) { return _mm256_max_ps(a, b); }
+        static Int truncate(Vec v) { return _mm256_cvttps_epi32(v); }
+        static Vec toFloat(Int v) { return _mm256_cvtepi32_ps(v); }
+        static Vec load(const float* p) { return _mm256_loadu_ps(p); }
+        static void store(float* p, Vec v) { _mm256_storeu_ps(p, v); }
+        
+        // Widening, exactly as grainSampleToFloat
+        static Vec fromInt16(Int v) { return _mm256_mul_ps(_mm256_cvtepi32_ps(v), _mm256_set1_ps(1.0f / 32768.0f)); }
+        static Vec fromHalf(Int v) {
+            const Int magnitude = _mm256_slli_epi32(_mm256_and_si256(v, _mm256_set1_epi32(0x7fff)), 13);
+            const Int sign = _mm256_slli_epi32(_mm256_and_si256(v, _mm256_set1_epi32(0x8000)), 16);
+            return _mm256_or_ps(_mm256_mul_ps(_mm256_castsi256_ps(magnitude), _mm256_set1_ps(0x1.0p112f)), _mm256_castsi256_ps(sign));
+        }
+        
+        static Vec loadSamples(const float* p) { return load(p); }
+        static Vec loadSamples(const int16_t* p) { return fromInt16(_mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)))); }
+        static Vec loadSamples(const GrainHalf* p) { return fromHalf(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)))); }
+        
+        // Eight interleaved frames, split by channel
+        static void loadStereoSamples(const float* p, Vec& left, Vec& right) {
+            const Vec a = _mm256_loadu_ps(p), b = _mm256_loadu_ps(p + 8);
+            
+            // Shuffles stay inside 128-bit halves; the permute restores frame order across them
+            const Vec l = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            const Vec r = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            left = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(l), _MM_SHUFFLE(3, 1, 2, 0)));
+            right = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(r), _MM_SHUFFLE(3, 1, 2, 0)));
+        }
+        static void loadStereoSamples(const int16_t* p, Vec& left, Vec& right) {
+            const Int frames = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            left = fromInt16(_mm256_srai_epi32(_mm256_slli_epi32(frames, 16), 16));
+            right = fromInt16(_mm256_srai_epi32(frames, 16));
+        }
+        static void loadStereoSamples(const GrainHalf* p, Vec& left, Vec& right) {
+            const Int frames = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            left = fromHalf(frames);
+            right = fromHalf(_mm256_srli_epi32(frames, 16));
+        }
+        
+        static float sum(Vec v) {
+            const __m128 halves = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+            const __m128 pairs = _mm_add_ps(halves, _mm_shuffle_ps(halves, halves, _MM_SHUFFLE(2, 3, 0, 1)));
+            return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_movehl_ps(pairs, pairs)));
+        }
+        
+        static void gatherPair(const float* base, Int index, Vec& first, Vec& second) {
+            first = _mm256_i32gather_ps(base, index, 4);
+            second = _mm256_i32gather_ps(base + 1, index, 4);
+        }
+        
+        // One 32-bit gather per lane picks up both neighbouring 16-bit samples
+        static void gatherPair(const int16_t* base, Int index, Vec& first, Vec& second) {
+            const Int pairs = _mm256_i32gather_epi32(reinterpret_cast<const int*>(base), index, 2);
+            first = fromInt16(_mm256_srai_epi32(_mm256_slli_epi32(pairs, 16), 16));
+            second = fromInt16(_mm256_srai_epi32(pairs, 16));
+        }
+        
+        static void gatherPair(const GrainHalf* base, Int index, Vec& first, Vec& second) {
+            const Int pairs = _mm256_i32gather_epi32(reinterpret_cast<const int*>(base), index, 2);
+            first = fromHalf(pairs); // Only looks at the low 16 bits
+            second = fromHalf(_mm256_srli_epi32(pairs, 16));
+        }
+        
+        // Frames index and index + 1 of an interleaved source, split by channel
+        static void gatherStereoPair(const float* base, Int index, Vec& firstL, Vec& firstR, Vec& secondL, Vec& secondR) {
+            const Int frame = _mm256_slli_epi32(index, 1);
+            firstL = _mm256_i32gather_ps(base, frame, 4);
+            firstR = _mm256_i32gather_ps(base + 1, frame, 4);
+            secondL = _mm256_i32gather_ps(base + 2, frame, 4);
+            secondR = _mm256_i32gather_ps(base + 3, frame, 4);
+        }
+        
+        // A 16-bit frame is one 32-bit gather
+        static void gatherStereoPair(const int16_t* base, Int index, Vec& firstL, Vec& firstR, Vec& secondL, Vec& secondR) {
+            const Int frame = _mm256_slli_epi32(index, 1);
+            const Int first = _mm256_i32gather_epi32(reinterpret_cast<const int*>(base), frame, 2);
+            const Int second = _mm256_i32gather_epi32(reinterpret_cast<const int*>(base + 2), frame, 2);
+            firstL = fromInt16(_mm256_srai_epi32(_mm256_slli_epi32(first, 16), 16));
+            firstR = fromInt16(_mm256_srai_epi32(first, 16));
+            secondL = fromInt16(_mm256_srai_epi32(_mm256_slli_epi32(second, 16), 16));
+            secondR = fromInt16(_mm256_srai_epi32(second, 16));
+        }
+        
+        static void gatherStereoPair(const GrainHalf* base, Int index, Vec& firstL, Vec& firstR, Vec& secondL, Vec& secondR) {
+            const Int frame = _mm256_slli_epi32(index, 1);
+            const Int first = _mm256_i32gather_epi32(reinterpret_cast<const int*>(base), frame, 2);
+            const Int second = _mm256_i32gather_epi32(reinterpret_cast<const int*>(base + 2), frame, 2);
+            firstL = fromHalf(first);
+            firstR = fromHalf(_mm256_srli_epi32(first, 16));
+            secondL = fromHalf(second);
+            secondR = fromHalf(_mm256_srli_epi32(second, 16));
+        }
+    };
+}
+
+const GrainKernel* getAvx2GrainKernels()
+{
+    static const struct Table {
+        Table() { GrainKernelsSimd::fillKernelTable<Avx2Ops>(kernels); }
+        GrainKernel kernels[numGrainKernels] {};
+    } table;
+    return table.kernels;
+}
+
+#else
+
+const GrainKernel* getAvx2GrainKernels() { return nullptr; }
+
+#endif
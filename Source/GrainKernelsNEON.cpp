@@ -0,0 +1,105 @@
+#include "GrainKernelsSimd.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#include <cstdint>
+
+namespace {
+    struct NeonOps {
+        using Vec = float32x4_t;
+        using Int = int32x4_t;
+        static constexpr int width = 4;
+        
+        static Vec set(float v) { return vdupq_n_f32(v); }
+        static Vec iota() { static const float lanes[4] = { 0.0f, 1.0f, 2.0f, 3.0f }; return vld1q_f32(lanes); }
+        static Vec add(Vec a, Vec b) { return vaddq_f32(a, b); }
+        static Vec sub(Vec a, Vec b) { return vsubq_f32(a, b); }
+        static Vec mul(Vec a, Vec b) { return vmulq_f32(a, b); }
+        static Vec mulAdd(Vec a, Vec b, Vec c) { return vaddq_f32(vmulq_f32(a, b), c); } // Unfused, to match the scalar path
+        static Vec min(Vec a, Vec b) { return vminq_f32(a, b); }
+        static Vec max(Vec a, Vec b) { return vmaxq_f32(a, b); }
+        static Int truncate(Vec v) { return vcvtq_s32_f32(v); }
+        static Vec toFloat(Int v) { return vcvtq_f32_s32(v); }
+        static Vec load(const float* p) { return vld1q_f32(p); }
+        static void store(float* p, Vec v) { vst1q_f32(p, v); }
+        
+        // Widening, exactly as grainSampleToFloat
+        static Vec fromInt16(Int v) { return vmulq_f32(vcvtq_f32_s32(v), vdupq_n_f32(1.0f / 32768.0f)); }
+        static Vec fromHalf(Int v) {
+            const uint32x4_t bits = vreinterpretq_u32_s32(v);
+            const uint32x4_t magnitude = vshlq_n_u32(vandq_u32(bits, vdupq_n_u32(0x7fff)), 13);
+            const uint32x4_t sign = vshlq_n_u32(vandq_u32(bits, vdupq_n_u32(0x8000)), 16);
+            const Vec scaled = vmulq_f32(vreinterpretq_f32_u32(magnitude), vdupq_n_f32(0x1.0p112f));
+            return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(scaled), sign));
+        }
+        
+        static Vec loadSamples(const float* p) { return load(p); }
+        static Vec loadSamples(const int16_t* p) { return fromInt16(vmovl_s16(vld1_s16(p))); }
+        static Vec loadSamples(const GrainHalf* p) { return fromHalf(vreinterpretq_s32_u32(vmovl_u16(vld1_u16(p)))); }
+        
+        // Four interleaved frames, split by channel by the de-interleaving loads
+        static void loadStereoSamples(const float* p, Vec& left, Vec& right) {
+            const float32x4x2_t frames = vld2q_f32(p);
+            left = frames.val[0];
+            right = frames.val[1];
+        }
+        static void loadStereoSamples(const int16_t* p, Vec& left, Vec& right) {
+            const int16x4x2_t frames = vld2_s16(p);
+            left = fromInt16(vmovl_s16(frames.val[0]));
+            right = fromInt16(vmovl_s16(frames.val[1]));
+        }
+        static void loadStereoSamples(const GrainHalf* p, Vec& left, Vec& right) {
+            const uint16x4x2_t frames = vld2_u16(p);
+            left = fromHalf(vreinterpretq_s32_u32(vmovl_u16(frames.val[0])));
+            right = fromHalf(vreinterpretq_s32_u32(vmovl_u16(frames.val[1])));
+        }
+        
+        static float sum(Vec v) {
+            const float32x2_t halves = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+            return vget_lane_f32(vpadd_f32(halves, halves), 0);
+        }
+        
+        template <typename Sample>
+        static void gatherPair(const Sample* base, Int index, Vec& first, Vec& second) {
+            int32_t i[4];
+            vst1q_s32(i, index);
+            const float a[4] = { grainSampleToFloat(base[i[0]]), grainSampleToFloat(base[i[1]]),
+                                 grainSampleToFloat(base[i[2]]), grainSampleToFloat(base[i[3]]) };
+            const float b[4] = { grainSampleToFloat(base[i[0] + 1]), grainSampleToFloat(base[i[1] + 1]),
+                                 grainSampleToFloat(base[i[2] + 1]), grainSampleToFloat(base[i[3] + 1]) };
+            first = vld1q_f32(a);
+            second = vld1q_f32(b);
+        }
+        
+        // Frames index and index + 1 of an interleaved source, split by channel
+        template <typename Sample>
+        static void gatherStereoPair(const Sample* base, Int index, Vec& firstL, Vec& firstR, Vec& secondL, Vec& secondR) {
+            int32_t i[4];
+            vst1q_s32(i, vshlq_n_s32(index, 1));
+            auto lanes = [base, &i](int offset) {
+                const float values[4] = { grainSampleToFloat(base[i[0] + offset]), grainSampleToFloat(base[i[1] + offset]),
+                                          grainSampleToFloat(base[i[2] + offset]), grainSampleToFloat(base[i[3] + offset]) };
+                return vld1q_f32(values);
+            };
+            firstL = lanes(0);
+            firstR = lanes(1);
+            secondL = lanes(2);
+            secondR = lanes(3);
+        }
+    };
+}
+
+const GrainKernel* getNeonGrainKernels()
+{
+    static const struct Table {
+        Table() { GrainKernelsSimd::fillKernelTable<NeonOps>(kernels); }
+        GrainKernel kernels[numGrainKernels] {};
+    } table;
+    return table.kernels;
+}
+
+#else
+
+const GrainKernel* getNeonGrainKernels() { return nullptr; }
+
+#endif
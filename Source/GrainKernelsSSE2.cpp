@@ -0,0 +1,107 @@
+#include "GrainKernelsSimd.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#include <cstdint>
+
+namespace {
+    struct Sse2Ops {
+        using Vec = __m128;
+        using Int = __m128i;
+        static constexpr int width = 4;
+        
+        static Vec set(float v) { return _mm_set1_ps(v); }
+        static Vec iota() { return _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f); }
+        static Vec add(Vec a, Vec b) { return _mm_add_ps(a, b); }
+        static Vec sub(Vec a, Vec b) { return _mm_sub_ps(a, b); }
+        static Vec mul(Vec a, Vec b) { return _mm_mul_ps(a, b); }
+        static Vec mulAdd(Vec a, Vec b, Vec c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+        static Vec min(Vec a, Vec b) { return _mm_min_ps(a, b); }
+        static Vec max(Vec a, Vec b) { return _mm_max_ps(a, b); }
+        static Int truncate(Vec v) { return _mm_cvttps_epi32(v); }
+        static Vec toFloat(Int v) { return _mm_cvtepi32_ps(v); }
+        static Vec load(const float* p) { return _mm_loadu_ps(p); }
+        static void store(float* p, Vec v) { _mm_storeu_ps(p, v); }
+        
+        // Widening, exactly as grainSampleToFloat
+        static Vec fromInt16(Int v) { return _mm_mul_ps(_mm_cvtepi32_ps(v), _mm_set1_ps(1.0f / 32768.0f)); }
+        static Vec fromHalf(Int v) {
+            const Int magnitude = _mm_slli_epi32(_mm_and_si128(v, _mm_set1_epi32(0x7fff)), 13);
+            const Int sign = _mm_slli_epi32(_mm_and_si128(v, _mm_set1_epi32(0x8000)), 16);
+            return _mm_or_ps(_mm_mul_ps(_mm_castsi128_ps(magnitude), _mm_set1_ps(0x1.0p112f)), _mm_castsi128_ps(sign));
+        }
+        
+        static Vec loadSamples(const float* p) { return load(p); }
+        static Vec loadSamples(const int16_t* p) {
+            const Int raw = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+            return fromInt16(_mm_srai_epi32(_mm_unpacklo_epi16(raw, raw), 16));
+        }
+        static Vec loadSamples(const GrainHalf* p) {
+            const Int raw = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+            return fromHalf(_mm_unpacklo_epi16(raw, _mm_setzero_si128()));
+        }
+        
+        // Four interleaved frames, split by channel
+        static void loadStereoSamples(const float* p, Vec& left, Vec& right) {
+            const Vec a = _mm_loadu_ps(p), b = _mm_loadu_ps(p + 4);
+            left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        }
+        static void loadStereoSamples(const int16_t* p, Vec& left, Vec& right) {
+            const Int frames = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            left = fromInt16(_mm_srai_epi32(_mm_slli_epi32(frames, 16), 16));
+            right = fromInt16(_mm_srai_epi32(frames, 16));
+        }
+        static void loadStereoSamples(const GrainHalf* p, Vec& left, Vec& right) {
+            const Int frames = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            left = fromHalf(frames); // Only looks at the low 16 bits
+            right = fromHalf(_mm_srli_epi32(frames, 16));
+        }
+        
+        static float sum(Vec v) {
+            const Vec pairs = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+            return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_movehl_ps(pairs, pairs)));
+        }
+        
+        // No gather instruction: extract the indices once and load both neighbours
+        template <typename Sample>
+        static void gatherPair(const Sample* base, Int index, Vec& first, Vec& second) {
+            alignas(16) int32_t i[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(i), index);
+            first = _mm_setr_ps(grainSampleToFloat(base[i[0]]), grainSampleToFloat(base[i[1]]),
+                                grainSampleToFloat(base[i[2]]), grainSampleToFloat(base[i[3]]));
+            second = _mm_setr_ps(grainSampleToFloat(base[i[0] + 1]), grainSampleToFloat(base[i[1] + 1]),
+                                 grainSampleToFloat(base[i[2] + 1]), grainSampleToFloat(base[i[3] + 1]));
+        }
+        
+        // Frames index and index + 1 of an interleaved source, split by channel
+        template <typename Sample>
+        static void gatherStereoPair(const Sample* base, Int index, Vec& firstL, Vec& firstR, Vec& secondL, Vec& secondR) {
+            alignas(16) int32_t i[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(i), _mm_slli_epi32(index, 1));
+            auto lanes = [base, &i](int offset) {
+                return _mm_setr_ps(grainSampleToFloat(base[i[0] + offset]), grainSampleToFloat(base[i[1] + offset]),
+                                   grainSampleToFloat(base[i[2] + offset]), grainSampleToFloat(base[i[3] + offset]));
+            };
+            firstL = lanes(0);
+            firstR = lanes(1);
+            secondL = lanes(2);
+            secondR = lanes(3);
+        }
+    };
+}
+
+const GrainKernel* getSse2GrainKernels()
+{
+    static const struct Table {
+        Table() { GrainKernelsSimd::fillKernelTable<Sse2Ops>(kernels); }
+        GrainKernel kernels[numGrainKernels] {};
+    } table;
+    return table.kernels;
+}
+
+#else
+
+const GrainKernel* getSse2GrainKernels() { return nullptr; }
+
+#endif
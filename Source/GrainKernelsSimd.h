@@ -0,0 +1,285 @@
+#pragma once
+#include "GrainSpan.h"
+
+// Vectorised grain kernels, shared by the per-instruction-set translation units.
+// Each unit supplies an Ops struct wrapping its intrinsics; the arithmetic is
+// ordered like GrainKernels::render so results match the scalar path
+// (linear and cubic are bit-exact without FMA; FMA and the sinc inner
+// product's lane-wise summation stay within rounding). Ops also widens the
+// compact sample formats with the same exact conversions as GrainSpan.h, and
+// splits interleaved stereo frames into a left and a right vector.
+namespace GrainKernelsSimd {
+    // static: must not be merged with copies compiled for other instruction sets
+    static inline float lookupWindow(const float* table, float phase) {
+        float index = phase * (float)grainWindowTableSize;
+        index = index < 0.0f ? 0.0f : ((float)grainWindowTableSize < index ? (float)grainWindowTableSize : index);
+        const int i = (int)index;
+        const float frac = index - (float)i;
+        return table[i] + frac * (table[i + 1] - table[i]);
+    }
+    
+    // Scalar reads for the tails, matching GrainKernels::Linear, Cubic and Direct
+    template <int Stride, typename Sample>
+    static inline float readLinear(const Sample* source, int index, float frac) {
+        const float s0 = grainSampleToFloat(source[index * Stride]);
+        return s0 + frac * (grainSampleToFloat(source[(index + 1) * Stride]) - s0);
+    }
+    
+    template <int Stride, typename Sample>
+    static inline float readCubic(const Sample* source, int index, float frac) {
+        const float ym1 = grainSampleToFloat(source[(index - 1) * Stride]), y0 = grainSampleToFloat(source[index * Stride]);
+        const float y1 = grainSampleToFloat(source[(index + 1) * Stride]), y2 = grainSampleToFloat(source[(index + 2) * Stride]);
+        const float c1 = 0.5f * (y1 - ym1);
+        const float c2 = ym1 - 2.5f * y0 + 2.0f * y1 - 0.5f * y2;
+        const float c3 = 0.5f * (y2 - ym1) + 1.5f * (y0 - y1);
+        return ((c3 * frac + c2) * frac + c1) * frac + y0;
+    }
+    
+    template <int Interpolation, int Stride, typename Sample>
+    static inline float readScalar(const Sample* source, int index, float frac) {
+        if constexpr (Interpolation == grainInterpolationCubic)
+            return readCubic<Stride>(source, index, frac);
+        else if constexpr (Interpolation == grainInterpolationDirect)
+            return grainSampleToFloat(source[index * Stride]);
+        else
+            return readLinear<Stride>(source, index, frac);
+    }
+    
+    template <typename Ops>
+    typename Ops::Vec cubicLanes(typename Ops::Vec ym1, typename Ops::Vec y0, typename Ops::Vec y1, typename Ops::Vec y2, typename Ops::Vec frac) {
+        using Vec = typename Ops::Vec;
+        const Vec c1 = Ops::mul(Ops::set(0.5f), Ops::sub(y1, ym1));
+        const Vec c2 = Ops::sub(Ops::add(Ops::sub(ym1, Ops::mul(Ops::set(2.5f), y0)), Ops::mul(Ops::set(2.0f), y1)), Ops::mul(Ops::set(0.5f), y2));
+        const Vec c3 = Ops::add(Ops::mul(Ops::set(0.5f), Ops::sub(y2, ym1)), Ops::mul(Ops::set(1.5f), Ops::sub(y0, y1)));
+        return Ops::mulAdd(Ops::mulAdd(Ops::mulAdd(c3, frac, c2), frac, c1), frac, y0);
+    }
+    
+    template <typename Ops, int Interpolation, typename Sample>
+    typename Ops::Vec readLanes(const Sample* source, typename Ops::Int index, typename Ops::Vec frac) {
+        using Vec = typename Ops::Vec;
+        
+        if constexpr (Interpolation == grainInterpolationCubic)
+        {
+            Vec ym1, y0, y1, y2;
+            Ops::gatherPair(source - 1, index, ym1, y0);
+            Ops::gatherPair(source + 1, index, y1, y2);
+            return cubicLanes<Ops>(ym1, y0, y1, y2, frac);
+        }
+        else
+        {
+            Vec s0, s1;
+            Ops::gatherPair(source, index, s0, s1);
+            if constexpr (Interpolation == grainInterpolationDirect)
+                return s0;
+            else
+                return Ops::mulAdd(frac, Ops::sub(s1, s0), s0);
+        }
+    }
+    
+    // Both channels of an interleaved source from one set of indices
+    template <typename Ops, int Interpolation, typename Sample>
+    void readStereoLanes(const Sample* source, typename Ops::Int index, typename Ops::Vec frac, typename Ops::Vec& left, typename Ops::Vec& right) {
+        using Vec = typename Ops::Vec;
+        
+        if constexpr (Interpolation == grainInterpolationCubic)
+        {
+            Vec ym1L, ym1R, y0L, y0R, y1L, y1R, y2L, y2R;
+            Ops::gatherStereoPair(source - 2, index, ym1L, ym1R, y0L, y0R);
+            Ops::gatherStereoPair(source + 2, index, y1L, y1R, y2L, y2R);
+            left = cubicLanes<Ops>(ym1L, y0L, y1L, y2L, frac);
+            right = cubicLanes<Ops>(ym1R, y0R, y1R, y2R, frac);
+        }
+        else
+        {
+            Vec s0L, s0R, s1L, s1R;
+            Ops::gatherStereoPair(source, index, s0L, s0R, s1L, s1R);
+            if constexpr (Interpolation == grainInterpolationDirect)
+            {
+                left = s0L;
+                right = s0R;
+            }
+            else
+            {
+                left = Ops::mulAdd(frac, Ops::sub(s1L, s0L), s0L);
+                right = Ops::mulAdd(frac, Ops::sub(s1R, s0R), s0R);
+            }
+        }
+    }
+    
+    // Linear, cubic and direct: one output sample per lane. Forward direct grains
+    // read consecutive frames, so they load them instead of gathering.
+    template <typename Ops, int Interpolation, typename Sample, bool Reverse, bool Stereo, bool Windowed>
+    void renderLanes(const GrainSpan& span) {
+        using Vec = typename Ops::Vec;
+        constexpr int width = Ops::width;
+        constexpr int stride = Stereo ? 2 : 1;
+        const Sample* source = static_cast<const Sample*>(span.source);
+        
+        const Vec lane = Ops::iota();
+        const Vec start = Ops::set(span.position);
+        const Vec step = Ops::set(Reverse ? -span.increment : span.increment);
+        const Vec phaseStart = Ops::set(span.phase);
+        const Vec phaseStep = Ops::set(span.phaseIncrement);
+        const Vec tableSize = Ops::set((float)grainWindowTableSize);
+        const Vec zero = Ops::set(0.0f);
+        const Vec gainL = Ops::set(span.gainL);
+        const Vec gainR = Ops::set(span.gainR);
+        
+        int i = 0;
+        for (; i + width <= span.numSamples; i += width)
+        {
+            const Vec k = Ops::add(Ops::set((float)i), lane);
+            
+            Vec envelopeValue = Ops::set(1.0f);
+            if constexpr (Windowed)
+            {
+                const Vec w = Ops::max(zero, Ops::min(tableSize, Ops::mul(Ops::mulAdd(k, phaseStep, phaseStart), tableSize)));
+                const auto wi = Ops::truncate(w);
+                const Vec wf = Ops::sub(w, Ops::toFloat(wi));
+                Vec w0, w1;
+                Ops::gatherPair(span.window, wi, w0, w1);
+                envelopeValue = Ops::mulAdd(wf, Ops::sub(w1, w0), w0);
+            }
+            
+            Vec sampleL, sampleR;
+            if constexpr (Interpolation == grainInterpolationDirect && !Reverse)
+            {
+                const Sample* frames = source + ((int)span.position + i) * stride;
+                if constexpr (Stereo)
+                {
+                    Ops::loadStereoSamples(frames, sampleL, sampleR);
+                }
+                else
+                {
+                    sampleL = Ops::loadSamples(frames);
+                    sampleR = sampleL;
+                }
+            }
+            else
+            {
+                const Vec position = Ops::mulAdd(k, step, start);
+                const auto index = Ops::truncate(position);
+                const Vec frac = Ops::sub(position, Ops::toFloat(index));
+                
+                if constexpr (Stereo)
+                {
+                    readStereoLanes<Ops, Interpolation>(source, index, frac, sampleL, sampleR);
+                }
+                else
+                {
+                    sampleL = readLanes<Ops, Interpolation>(source, index, frac);
+                    sampleR = sampleL;
+                }
+            }
+            
+            Ops::store(span.mixL + i, Ops::mulAdd(Ops::mul(sampleL, envelopeValue), gainL, Ops::load(span.mixL + i)));
+            Ops::store(span.mixR + i, Ops::mulAdd(Ops::mul(sampleR, envelopeValue), gainR, Ops::load(span.mixR + i)));
+        }
+        
+        // Scalar tail
+        for (; i < span.numSamples; ++i)
+        {
+            const float offset = (float)i * span.increment;
+            const float position = Reverse ? span.position - offset : span.position + offset;
+            const int index = (int)position;
+            const float frac = position - (float)index;
+            
+            const float envelopeValue = Windowed ? lookupWindow(span.window, span.phase + (float)i * span.phaseIncrement) : 1.0f;
+            const float sampleL = readScalar<Interpolation, stride>(source, index, frac);
+            const float sampleR = Stereo ? readScalar<Interpolation, stride>(source + 1, index, frac) : sampleL;
+            
+            span.mixL[i] += sampleL * envelopeValue * span.gainL;
+            span.mixR[i] += sampleR * envelopeValue * span.gainR;
+        }
+    }
+    
+    // Sinc: one output sample at a time, with the tap inner product across the lanes
+    template <typename Ops, typename Sample, bool Reverse, bool Stereo, bool Windowed>
+    void renderSinc(const GrainSpan& span) {
+        using Vec = typename Ops::Vec;
+        constexpr int width = Ops::width;
+        constexpr int samplesBefore = grainSincTaps / 2 - 1;
+        constexpr int stride = Stereo ? 2 : 1;
+        static_assert(grainSincTaps % width == 0, "Sinc taps must fill whole vectors");
+        
+        for (int i = 0; i < span.numSamples; ++i)
+        {
+            const float offset = (float)i * span.increment;
+            const float position = Reverse ? span.position - offset : span.position + offset;
+            const int index = (int)position;
+            const float phase = (position - (float)index) * (float)grainSincPhases;
+            const int row = (int)phase;
+            const Vec rowFrac = Ops::set(phase - (float)row);
+            const float* taps0 = span.sincTable + row * grainSincTaps;
+            const float* taps1 = taps0 + grainSincTaps;
+            const Sample* samples = static_cast<const Sample*>(span.source) + (index - samplesBefore) * stride;
+            
+            Vec sumL = Ops::set(0.0f);
+            Vec sumR = sumL;
+            for (int k = 0; k < grainSincTaps; k += width)
+            {
+                const Vec t0 = Ops::load(taps0 + k);
+                const Vec taps = Ops::mulAdd(rowFrac, Ops::sub(Ops::load(taps1 + k), t0), t0);
+                if constexpr (Stereo)
+                {
+                    Vec left, right;
+                    Ops::loadStereoSamples(samples + k * 2, left, right);
+                    sumL = Ops::mulAdd(taps, left, sumL);
+                    sumR = Ops::mulAdd(taps, right, sumR);
+                }
+                else
+                {
+                    sumL = Ops::mulAdd(taps, Ops::loadSamples(samples + k), sumL);
+                }
+            }
+            
+            const float envelopeValue = Windowed ? lookupWindow(span.window, span.phase + (float)i * span.phaseIncrement) : 1.0f;
+            const float sampleL = Ops::sum(sumL);
+            const float sampleR = Stereo ? Ops::sum(sumR) : sampleL;
+            
+            span.mixL[i] += sampleL * envelopeValue * span.gainL;
+            span.mixR[i] += sampleR * envelopeValue * span.gainR;
+        }
+    }
+    
+    template <typename Ops, int Interpolation, typename Sample, bool Reverse, bool Stereo, bool Windowed>
+    GrainKernel kernelFor() {
+        if constexpr (Interpolation == grainInterpolationSinc)
+            return &renderSinc<Ops, Sample, Reverse, Stereo, Windowed>;
+        else
+            return &renderLanes<Ops, Interpolation, Sample, Reverse, Stereo, Windowed>;
+    }
+    
+    template <typename Ops, int Interpolation, typename Sample>
+    void fillInterpolation(GrainKernel* table, int format) {
+        table[grainKernelIndex(format, Interpolation, false, false, false)] = kernelFor<Ops, Interpolation, Sample, false, false, false>();
+        table[grainKernelIndex(format, Interpolation, false, false, true)]  = kernelFor<Ops, Interpolation, Sample, false, false, true>();
+        table[grainKernelIndex(format, Interpolation, false, true,  false)] = kernelFor<Ops, Interpolation, Sample, false, true,  false>();
+        table[grainKernelIndex(format, Interpolation, false, true,  true)]  = kernelFor<Ops, Interpolation, Sample, false, true,  true>();
+        table[grainKernelIndex(format, Interpolation, true,  false, false)] = kernelFor<Ops, Interpolation, Sample, true,  false, false>();
+        table[grainKernelIndex(format, Interpolation, true,  false, true)]  = kernelFor<Ops, Interpolation, Sample, true,  false, true>();
+        table[grainKernelIndex(format, Interpolation, true,  true,  false)] = kernelFor<Ops, Interpolation, Sample, true,  true,  false>();
+        table[grainKernelIndex(format, Interpolation, true,  true,  true)]  = kernelFor<Ops, Interpolation, Sample, true,  true,  true>();
+    }
+    
+    template <typename Ops, typename Sample>
+    void fillFormat(GrainKernel* table, int format) {
+        fillInterpolation<Ops, grainInterpolationLinear, Sample>(table, format);
+        fillInterpolation<Ops, grainInterpolationCubic, Sample>(table, format);
+        fillInterpolation<Ops, grainInterpolationSinc, Sample>(table, format);
+        fillInterpolation<Ops, grainInterpolationDirect, Sample>(table, format);
+    }
+    
+    template <typename Ops>
+    void fillKernelTable(GrainKernel* table) {
+        fillFormat<Ops, float>(table, grainSampleFloat32);
+        fillFormat<Ops, int16_t>(table, grainSampleInt16);
+        fillFormat<Ops, GrainHalf>(table, grainSampleFloat16);
+    }
+}
+
+// Entry points implemented by the per-instruction-set files.
+// Each returns nullptr when built for an architecture without that instruction set.
+const GrainKernel* getSse2GrainKernels();
+const GrainKernel* getAvx2GrainKernels();
+const GrainKernel* getNeonGrainKernels();
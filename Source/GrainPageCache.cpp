@@ -0,0 +1,162 @@
+#include "GrainPageCache.h"
+
+GrainPageCache::GrainPageCache(std::unique_ptr<juce::AudioFormatReader> r, size_t budgetBytes, int numGuardSamples)
+    : reader(std::move(r)),
+      numChannels(juce::jlimit(1, 2, (int)reader->numChannels)),
+      numSamples((int)juce::jmax((juce::int64)1, reader->lengthInSamples)),
+      numPages((numSamples + pageLength - 1) / pageLength),
+      guardSamples(numGuardSamples)
+{
+    pageSlots.reset(new std::atomic<int>[(size_t)numPages]);
+    pageWanted.reset(new std::atomic<juce::uint32>[(size_t)numPages]);
+    for (int p = 0; p < numPages; ++p)
+    {
+        pageSlots[(size_t)p].store(-1, std::memory_order_relaxed);
+        pageWanted[(size_t)p].store(0, std::memory_order_relaxed);
+    }
+    
+    // At least a few slots so neighbouring pages can be resident together
+    const size_t slotBytes = (size_t)numChannels * (size_t)(pageLength + 2 * guardSamples) * sizeof(float);
+    const int numSlots = juce::jlimit(4, juce::jmax(4, numPages), (int)(budgetBytes / slotBytes));
+    slots.resize((size_t)numSlots);
+    for (auto& slot : slots)
+        slot.storage.calloc((size_t)(numChannels * (pageLength + 2 * guardSamples)));
+    readBuffer.setSize(numChannels, pageLength + 2 * guardSamples);
+}
+
+size_t GrainPageCache::getMemoryBytes() const
+{
+    return slots.size() * (size_t)numChannels * (size_t)(pageLength + 2 * guardSamples) * sizeof(float);
+}
+
+const float* GrainPageCache::getPage(int page) const
+{
+    if (!juce::isPositiveAndBelow(page, numPages))
+        return nullptr;
+        
+    // Sequentially consistent, like the unmap and epoch check in evict(): store-then-load on
+    // both sides, so either evict() sees this block's epoch or this sees the unmapped slot
+    const int slot = pageSlots[(size_t)page].load(std::memory_order_seq_cst);
+    if (slot < 0)
+        return nullptr;
+        
+    return slots[(size_t)slot].storage.get() + guardSamples * numChannels;
+}
+
+void GrainPageCache::markWanted(int first, int count) const
+{
+    const auto stamp = getStamp();
+    
+    // Beyond a quarter of the cache a request would only evict itself; keep its middle
+    const int maxSamples = juce::jmax(1, (int)slots.size() / 4 - 1) * pageLength;
+    if (count > maxSamples)
+    {
+        first += (count - maxSamples) / 2;
+        count = maxSamples;
+    }
+    const int numToMark = juce::jmin(count / pageLength + 2, numPages);
+    
+    int page = (((first % numSamples) + numSamples) % numSamples) / pageLength;
+    for (int i = 0; i < numToMark; ++i)
+    {
+        pageWanted[(size_t)page].store(stamp, std::memory_order_relaxed);
+        page = page + 1 < numPages ? page + 1 : 0;
+    }
+}
+
+bool GrainPageCache::service()
+{
+    // The most recently wanted page that isn't resident yet
+    const auto now = getStamp();
+    int best = -1;
+    juce::uint32 bestStamp = 0;
+    
+    for (int p = 0; p < numPages; ++p)
+    {
+        const auto stamp = pageWanted[(size_t)p].load(std::memory_order_relaxed);
+        if (stamp > bestStamp && now - stamp <= wantedForBlocks && pageSlots[(size_t)p].load(std::memory_order_relaxed) < 0)
+        {
+            best = p;
+            bestStamp = stamp;
+        }
+    }
+    
+    if (best < 0)
+        return false;
+        
+    const int slotIndex = findSlotFor(bestStamp);
+    if (slotIndex < 0)
+        return false;
+        
+    auto& slot = slots[(size_t)slotIndex];
+    evict(slot);
+    read(slot, best);
+    
+    slot.page = best;
+    pageSlots[(size_t)best].store(slotIndex, std::memory_order_release);
+    return true;
+}
+
+int GrainPageCache::findSlotFor(juce::uint32 stamp) const
+{
+    // A free slot, else the least recently wanted page if it is wanted less than the new one
+    int oldest = -1;
+    juce::uint32 oldestStamp = stamp;
+    
+    for (int s = 0; s < (int)slots.size(); ++s)
+    {
+        const int page = slots[(size_t)s].page;
+        if (page < 0)
+            return s;
+            
+        const auto pageStamp = pageWanted[(size_t)page].load(std::memory_order_relaxed);
+        if (pageStamp < oldestStamp)
+        {
+            oldest = s;
+            oldestStamp = pageStamp;
+        }
+    }
+    return oldest;
+}
+
+void GrainPageCache::evict(Slot& slot)
+{
+    if (slot.page < 0)
+        return;
+        
+    pageSlots[(size_t)slot.page].store(-1);
+    slot.page = -1;
+    
+    // A block that started before the unmap may still hold the old pointer
+    const auto started = epoch.load();
+    if ((started & 1) != 0)
+        while (epoch.load() == started)
+            juce::Thread::sleep(1);
+}
+
+void GrainPageCache::read(Slot& slot, int page)
+{
+    const int start = page * pageLength;
+    const int length = juce::jmin(pageLength, numSamples - start);
+    
+    // Page and guards, taken from the wrapped file position
+    int written = 0;
+    int position = start - guardSamples;
+    const int total = length + 2 * guardSamples;
+    
+    while (written < total)
+    {
+        const int wrapped = ((position % numSamples) + numSamples) % numSamples;
+        const int chunk = juce::jmin(total - written, numSamples - wrapped);
+        reader->read(&readBuffer, written, chunk, wrapped, true, true);
+        written += chunk;
+        position += chunk;
+    }
+    
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const float* samples = readBuffer.getReadPointer(ch);
+        for (int i = 0; i < total; ++i)
+            slot.storage[i * numChannels + ch] = samples[i];
+    }
+}
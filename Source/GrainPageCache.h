@@ -0,0 +1,72 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Bounded page cache that streams a long sample from disk
+// The file is split into fixed-length pages. A fixed pool of slots holds the
+// resident ones as float frames (mono, or interleaved stereo like
+// GrainSource), each with guard frames copied from its neighbours (wrapped at
+// the file ends) so the grain kernels read a page exactly like a resident
+// source. The audio thread only stamps the pages it wants and reads resident
+// pages. The loader thread calls service() to read the most recently wanted
+// missing pages, evicting the least recently wanted ones when the pool is full.
+//
+// A slot is only reused once the audio thread can no longer be reading it:
+// eviction unmaps the page first, then waits until any block in progress
+// (tracked by an epoch counter that is odd during a block) has finished.
+class GrainPageCache {
+public:
+    static constexpr int pageLength = 1 << 16;
+    
+    // Not real-time safe. numGuardSamples matches GrainSource::guardSamples.
+    GrainPageCache(std::unique_ptr<juce::AudioFormatReader> reader, size_t budgetBytes, int numGuardSamples);
+    
+    int getNumChannels() const { return numChannels; }
+    int getNumSamples() const { return numSamples; }
+    size_t getMemoryBytes() const;
+    
+    // Audio thread. Brackets every block that reads pages.
+    void beginBlock() const { epoch.fetch_add(1); }
+    void endBlock() const { epoch.fetch_add(1); }
+    
+    // Audio thread: points at the page's first frame, or nullptr while it isn't resident
+    const float* getPage(int page) const;
+    
+    // Audio thread: asks for the pages covering count samples from first (wrapping at the end)
+    void markWanted(int first, int count) const;
+    
+    // Pages read while not resident, since construction
+    int getNumMisses() const { return misses.load(std::memory_order_relaxed); }
+    void countMiss() const { misses.fetch_add(1, std::memory_order_relaxed); }
+    
+    // Loader thread: loads at most one page; returns false when there is nothing it can load
+    bool service();
+
+private:
+    struct Slot {
+        juce::HeapBlock<float> storage; // Frames, guards included
+        int page = -1;
+    };
+    
+    static constexpr juce::uint32 wantedForBlocks = 64; // Older requests are ignored
+    
+    juce::uint32 getStamp() const { return (epoch.load(std::memory_order_relaxed) >> 1) + 1; }
+    int findSlotFor(juce::uint32 stamp) const;
+    void evict(Slot& slot);
+    void read(Slot& slot, int page);
+    
+    std::unique_ptr<juce::AudioFormatReader> reader; // Loader thread only
+    juce::AudioBuffer<float> readBuffer;              // Likewise: one page as read, before interleaving
+    int numChannels = 1;
+    int numSamples = 0;
+    int numPages = 0;
+    int guardSamples = 0;
+    
+    std::vector<Slot> slots;
+    std::unique_ptr<std::atomic<int>[]> pageSlots;           // Slot holding each page, or -1
+    std::unique_ptr<std::atomic<juce::uint32>[]> pageWanted; // Stamp of the last request, 0 = never
+    
+    mutable std::atomic<juce::uint32> epoch { 0 };
+    mutable std::atomic<int> misses { 0 };
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GrainPageCache)
+};
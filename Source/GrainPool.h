@@ -0,0 +1,56 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Fixed-capacity grain storage for the audio thread
+// Storage is sized once in allocate() (from prepare); add/remove never touch the heap.
+// Removal swaps the last grain into the freed slot, so iteration order is not spawn order.
+template <typename GrainType>
+class GrainPool {
+public:
+    // Not real-time safe: call from prepare() only
+    void allocate(int capacity) {
+        storage.resize((size_t)juce::jmax(0, capacity));
+        count = 0;
+    }
+
+    // O(1): copies the grain into a free slot, returns false when the pool is full
+    bool add(const GrainType& grain) {
+        jassert(!storage.empty()); // allocate() must be called before rendering
+        if (count >= (int)storage.size())
+            return false;
+        storage[(size_t)count++] = grain;
+        return true;
+    }
+
+    // O(1): swap-with-last removal
+    void remove(int index) {
+        jassert(juce::isPositiveAndBelow(index, count));
+        storage[(size_t)index] = storage[(size_t)--count];
+    }
+
+    template <typename Predicate>
+    void removeIf(Predicate shouldRemove) {
+        for (int i = count - 1; i >= 0; --i)
+            if (shouldRemove(storage[(size_t)i]))
+                remove(i);
+    }
+
+    void clear() { count = 0; }
+
+    int size() const { return count; }
+    int capacity() const { return (int)storage.size(); }
+    bool empty() const { return count == 0; }
+    bool isFull() const { return count >= (int)storage.size(); }
+
+    GrainType& operator[](int index) { return storage[(size_t)index]; }
+    const GrainType& operator[](int index) const { return storage[(size_t)index]; }
+
+    GrainType* begin() { return storage.data(); }
+    GrainType* end() { return storage.data() + count; }
+    const GrainType* begin() const { return storage.data(); }
+    const GrainType* end() const { return storage.data() + count; }
+
+private:
+    std::vector<GrainType> storage;
+    int count = 0;
+};
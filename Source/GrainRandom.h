@@ -0,0 +1,46 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Counter-based random numbers for grain randomisation
+// Value n of a stream is a hash of the stream key and n, so a stream replays
+// exactly from its key, and fill() is independent integer lanes that the
+// compiler vectorises. Statistical quality only; not for cryptography.
+class GrainRandom {
+public:
+    // Restarts the stream at value 0
+    void setKey(juce::uint32 newKey) {
+        key = newKey;
+        counter = 0;
+    }
+    
+    // [0, 1)
+    float nextFloat() { return toUnit(hash(key, counter++)); }
+    
+    // [-1, 1)
+    float nextBipolar() { return nextFloat() * 2.0f - 1.0f; }
+    
+    // The next num values of nextFloat(), in one pass
+    void fill(float* destination, int num) {
+        const juce::uint32 first = counter;
+        for (int i = 0; i < num; ++i)
+            destination[i] = toUnit(hash(key, first + (juce::uint32)i));
+        counter += (juce::uint32)num;
+    }
+    
+    // 32-bit integer finaliser (lowbias32): every input bit affects every output bit
+    static juce::uint32 mix(juce::uint32 x) {
+        x ^= x >> 16;
+        x *= 0x7feb352du;
+        x ^= x >> 15;
+        x *= 0x846ca68bu;
+        x ^= x >> 16;
+        return x;
+    }
+
+private:
+    static juce::uint32 hash(juce::uint32 streamKey, juce::uint32 n) { return mix(streamKey + n * 0x9e3779b9u); }
+    static float toUnit(juce::uint32 x) { return (float)(x >> 8) * (1.0f / 16777216.0f); }
+    
+    juce::uint32 key = 0;
+    juce::uint32 counter = 0;
+};
@@ -0,0 +1,120 @@
+#include "GrainResampler.h"
+
+namespace {
+    // Sinc zero crossings either side of the centre; with the Kaiser beta this
+    // gives roughly 90 dB of stopband and a transition band of about a tenth of Nyquist
+    constexpr int zeroCrossings = 32;
+    constexpr double beta = 9.0;
+    constexpr double passband = 0.9; // Of the lower Nyquist, leaving room for the transition band
+    constexpr int numPhases = 512;
+    
+    // How many output samples between cancellation checks
+    constexpr int stopCheckInterval = 1 << 16;
+    
+    double besselI0(double x)
+    {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 64; ++k)
+        {
+            const double t = x / (2.0 * k);
+            term *= t * t;
+            sum += term;
+            if (term < sum * 1.0e-12)
+                break;
+        }
+        return sum;
+    }
+    
+    // numPhases + 1 rows of numTaps coefficients; row p is the filter for a read
+    // position p / numPhases past source[index], starting at source[index - samplesBefore]
+    struct PolyphaseFilter {
+        explicit PolyphaseFilter(double cutoff)
+        {
+            const double halfWidth = (double)zeroCrossings / cutoff;
+            numTaps = 2 * (int)std::ceil(halfWidth);
+            samplesBefore = numTaps / 2 - 1;
+            coefficients.resize((size_t)((numPhases + 1) * numTaps));
+            const double normaliser = besselI0(beta);
+            
+            for (int phase = 0; phase <= numPhases; ++phase)
+            {
+                const double frac = (double)phase / (double)numPhases;
+                float* taps = coefficients.data() + phase * numTaps;
+                double sum = 0.0;
+                
+                for (int k = 0; k < numTaps; ++k)
+                {
+                    const double x = (double)(k - samplesBefore) - frac;
+                    const double arg = juce::MathConstants<double>::pi * cutoff * x;
+                    const double sinc = std::abs(arg) < 1.0e-9 ? 1.0 : std::sin(arg) / arg;
+                    const double t = juce::jlimit(-1.0, 1.0, x / halfWidth);
+                    const double h = cutoff * sinc * besselI0(beta * std::sqrt(1.0 - t * t)) / normaliser;
+                    taps[k] = (float)h;
+                    sum += h;
+                }
+                
+                // Unity gain at DC for every phase
+                for (int k = 0; k < numTaps; ++k)
+                    taps[k] = (float)((double)taps[k] / sum);
+            }
+        }
+        
+        std::vector<float> coefficients;
+        int numTaps = 0;
+        int samplesBefore = 0;
+    };
+}
+
+juce::AudioBuffer<float> GrainResampler::convert(const juce::AudioBuffer<float>& input, double inputRate, double outputRate,
+                                                 const std::function<bool()>& shouldStop)
+{
+    const int inputLength = input.getNumSamples();
+    if (inputLength <= 0 || inputRate <= 0.0 || outputRate <= 0.0)
+        return {};
+    
+    const double step = inputRate / outputRate;
+    const int outputLength = (int)juce::jlimit(1.0, (double)std::numeric_limits<int>::max(), std::round((double)inputLength / step));
+    
+    // Downsampling moves the cutoff down to the new Nyquist
+    const PolyphaseFilter filter (passband * juce::jmin(1.0, outputRate / inputRate));
+    const int numTaps = filter.numTaps;
+    
+    juce::AudioBuffer<float> output (input.getNumChannels(), outputLength);
+    std::vector<float> padded;
+    
+    for (int ch = 0; ch < input.getNumChannels(); ++ch)
+    {
+        // Wrapped copies either side, so the taps never need bounds checks
+        const float* source = input.getReadPointer(ch);
+        padded.resize((size_t)(inputLength + 2 * numTaps));
+        for (int j = 0; j < (int)padded.size(); ++j)
+            padded[(size_t)j] = source[((j - filter.samplesBefore) % inputLength + inputLength) % inputLength];
+        
+        float* destination = output.getWritePointer(ch);
+        for (int i = 0; i < outputLength; ++i)
+        {
+            const double position = (double)i * step;
+            const int index = juce::jmin((int)position, inputLength - 1);
+            const double phase = (position - (double)index) * (double)numPhases;
+            const int row = juce::jmin((int)phase, numPhases - 1);
+            const float rowFrac = (float)(phase - (double)row);
+            const float* taps0 = filter.coefficients.data() + row * numTaps;
+            const float* taps1 = taps0 + numTaps;
+            const float* samples = padded.data() + index;
+            
+            // Both neighbouring phases, then blend: same result as blending the taps, and vectorises
+            float sum0 = 0.0f, sum1 = 0.0f;
+            for (int k = 0; k < numTaps; ++k)
+            {
+                sum0 += taps0[k] * samples[k];
+                sum1 += taps1[k] * samples[k];
+            }
+            destination[i] = sum0 + rowFrac * (sum1 - sum0);
+            
+            if ((i & (stopCheckInterval - 1)) == 0 && shouldStop())
+                return {};
+        }
+    }
+    
+    return output;
+}
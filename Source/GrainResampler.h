@@ -0,0 +1,15 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Offline sample-rate conversion for loaded samples
+// Converts a whole decoded sample once, on the loader thread, so grains can
+// read it at the session rate instead of scaling every grain's step by the
+// rate ratio. Kaiser-windowed sinc with the cutoff just below the lower of the
+// two Nyquists, evaluated from a polyphase table with interpolated phases (so
+// any ratio works, not just small rational ones). The input is treated as a
+// loop, like the grains that play it, so the seam stays continuous.
+namespace GrainResampler {
+    // Not real-time safe. Returns an empty buffer if shouldStop() turns true first.
+    juce::AudioBuffer<float> convert(const juce::AudioBuffer<float>& input, double inputRate, double outputRate,
+                                     const std::function<bool()>& shouldStop);
+}
@@ -0,0 +1,252 @@
+#include "GrainSource.h"
+
+namespace {
+    // Decimation lowpass: Kaiser-windowed sinc cutting off just below the new Nyquist
+    constexpr int decimationTaps = 63;
+    
+    const std::array<float, decimationTaps>& getDecimationFilter()
+    {
+        static const auto filter = [] {
+            std::array<float, decimationTaps> h {};
+            const double cutoff = 0.23; // Cycles per input sample; half-rate Nyquist is 0.25
+            const double beta = 7.0;
+            const int centre = decimationTaps / 2;
+            
+            auto besselI0 = [](double x) {
+                double sum = 1.0, term = 1.0;
+                for (int k = 1; k < 32; ++k)
+                {
+                    const double t = x / (2.0 * k);
+                    term *= t * t;
+                    sum += term;
+                }
+                return sum;
+            };
+            
+            double sum = 0.0;
+            for (int k = 0; k < decimationTaps; ++k)
+            {
+                const double x = (double)(k - centre);
+                const double arg = juce::MathConstants<double>::twoPi * cutoff * x;
+                const double sinc = k == centre ? 1.0 : std::sin(arg) / arg;
+                const double t = x / (double)centre;
+                const double value = 2.0 * cutoff * sinc * besselI0(beta * std::sqrt(1.0 - t * t)) / besselI0(beta);
+                h[(size_t)k] = (float)value;
+                sum += value;
+            }
+            
+            // Unity gain at DC
+            for (auto& tap : h)
+                tap = (float)((double)tap / sum);
+            return h;
+        }();
+        return filter;
+    }
+}
+
+GrainSource::GrainSource(const juce::AudioBuffer<float>& source, double rate, juce::uint32 serial, GrainSampleFormat sampleFormat)
+    : numChannels(juce::jlimit(1, 2, source.getNumChannels())),
+      sampleRate(rate),
+      serialNumber(serial),
+      format(sampleFormat)
+{
+    const int numSamples = juce::jmax(1, source.getNumSamples());
+    allocateLevel(0, numSamples);
+    
+    std::vector<float> samples ((size_t)(numSamples + 2 * guardSamples));
+    for (int ch = 0; ch < juce::jmin(numChannels, source.getNumChannels()); ++ch)
+    {
+        float* data = samples.data() + guardSamples;
+        juce::FloatVectorOperations::copy(data, source.getReadPointer(ch), source.getNumSamples());
+        fillGuards(data, numSamples);
+        encodeChannel(0, ch, samples.data());
+    }
+    
+    numReadyLevels.store(1, std::memory_order_release);
+}
+
+GrainSource::GrainSource(std::unique_ptr<juce::AudioFormatReader> reader, size_t cacheBudgetBytes, juce::uint32 serial)
+    : numChannels(juce::jlimit(1, 2, (int)reader->numChannels)),
+      sampleRate(reader->sampleRate),
+      serialNumber(serial)
+{
+    pageCache = std::make_unique<GrainPageCache>(std::move(reader), cacheBudgetBytes, guardSamples);
+    levels[0].numSamples = pageCache->getNumSamples();
+    numReadyLevels.store(1, std::memory_order_release);
+}
+
+int GrainSource::getLevelForIncrement(float increment) const
+{
+    const int numLevels = getNumLevels();
+    int level = 0;
+    while (level + 1 < numLevels && increment >= (float)(2 << level))
+        ++level;
+    return level;
+}
+
+void GrainSource::buildPyramid(size_t budgetBytes, const std::function<bool()>& shouldStop)
+{
+    // Streamed sources play from level 0 only
+    if (isStreaming())
+        return;
+        
+    const auto& filter = getDecimationFilter();
+    const int centre = decimationTaps / 2;
+    size_t usedBytes = 0;
+    std::vector<float> inputScratch, outputSamples;
+    
+    for (int level = getNumLevels(); level < maxLevels; ++level)
+    {
+        const int inputLength = levels[(size_t)(level - 1)].numSamples;
+        const int outputLength = (inputLength + 1) / 2;
+        
+        // Below this a level saves nothing worth the memory
+        if (inputLength < 2 * decimationTaps)
+            break;
+        
+        const size_t levelBytes = getLevelBytes(outputLength);
+        if (usedBytes + levelBytes > budgetBytes)
+            break;
+        
+        allocateLevel(level, outputLength);
+        outputSamples.resize((size_t)(outputLength + 2 * guardSamples));
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            // Filtered in float whatever the storage format
+            const float* input = decodeChannel(level - 1, ch, inputScratch) + guardSamples;
+            float* output = outputSamples.data() + guardSamples;
+            
+            for (int i = 0; i < outputLength; ++i)
+            {
+                const int first = 2 * i - centre;
+                float sum = 0.0f;
+                
+                if (first >= 0 && first + decimationTaps <= inputLength)
+                {
+                    for (int k = 0; k < decimationTaps; ++k)
+                        sum += filter[(size_t)k] * input[first + k];
+                }
+                else
+                {
+                    // Grains wrap around the sample end, so the filter does too
+                    for (int k = 0; k < decimationTaps; ++k)
+                        sum += filter[(size_t)k] * input[((first + k) % inputLength + inputLength) % inputLength];
+                }
+                
+                output[i] = sum;
+            }
+            
+            fillGuards(output, outputLength);
+            encodeChannel(level, ch, outputSamples.data());
+            
+            if (shouldStop())
+                return;
+        }
+        
+        usedBytes += levelBytes;
+        numReadyLevels.store(level + 1, std::memory_order_release);
+    }
+}
+
+size_t GrainSource::getMemoryBytes() const
+{
+    if (isStreaming())
+        return pageCache->getMemoryBytes();
+        
+    size_t bytes = 0;
+    for (int level = 0; level < getNumLevels(); ++level)
+        bytes += getLevelBytes(levels[(size_t)level].numSamples);
+    return bytes;
+}
+
+size_t GrainSource::getLevelBytes(int numSamples) const
+{
+    return (size_t)(numSamples + 2 * guardSamples) * (size_t)getBytesPerFrame();
+}
+
+void GrainSource::allocateLevel(int level, int numSamples)
+{
+    auto& destination = levels[(size_t)level];
+    destination.numSamples = numSamples;
+    destination.storage.calloc(getLevelBytes(numSamples));
+}
+
+const float* GrainSource::decodeChannel(int level, int channel, std::vector<float>& scratch) const
+{
+    const int total = levels[(size_t)level].numSamples + 2 * guardSamples;
+    const char* data = levels[(size_t)level].storage.get() + channel * grainSampleBytes(format);
+    
+    if (format == grainSampleFloat32 && numChannels == 1)
+        return reinterpret_cast<const float*>(data);
+        
+    scratch.resize((size_t)total);
+    for (int i = 0; i < total; ++i)
+    {
+        const int frame = i * numChannels;
+        switch (format) {
+            case grainSampleInt16:   scratch[(size_t)i] = grainSampleToFloat(reinterpret_cast<const int16_t*>(data)[frame]); break;
+            case grainSampleFloat16: scratch[(size_t)i] = grainSampleToFloat(reinterpret_cast<const GrainHalf*>(data)[frame]); break;
+            default:                 scratch[(size_t)i] = reinterpret_cast<const float*>(data)[frame]; break;
+        }
+    }
+    return scratch.data();
+}
+
+void GrainSource::encodeChannel(int level, int channel, const float* samples)
+{
+    const int total = levels[(size_t)level].numSamples + 2 * guardSamples;
+    char* data = levels[(size_t)level].storage.get() + channel * grainSampleBytes(format);
+    
+    switch (format) {
+        case grainSampleInt16:   encodeSamples(samples, reinterpret_cast<int16_t*>(data), total, numChannels); break;
+        case grainSampleFloat16: encodeSamples(samples, reinterpret_cast<GrainHalf*>(data), total, numChannels); break;
+        default:
+            for (int i = 0; i < total; ++i)
+                reinterpret_cast<float*>(data)[i * numChannels] = samples[i];
+            break;
+    }
+}
+
+void GrainSource::encodeSamples(const float* source, int16_t* destination, int numSamples, int destinationStride)
+{
+    for (int i = 0; i < numSamples; ++i)
+        destination[i * destinationStride] = (int16_t)juce::jlimit(-32768, 32767, juce::roundToInt(source[i] * 32768.0f));
+}
+
+void GrainSource::encodeSamples(const float* source, GrainHalf* destination, int numSamples, int destinationStride)
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto& output = destination[i * destinationStride];
+        uint32_t bits;
+        std::memcpy(&bits, source + i, sizeof(float));
+        const auto sign = (GrainHalf)((bits >> 16) & 0x8000u);
+        
+        // NaN lands here too
+        const float magnitude = std::abs(source[i]);
+        if (!(magnitude >= 0x1.0p-14f))
+        {
+            output = sign;
+            continue;
+        }
+        
+        // Rebias the exponent, then round the mantissa to 10 bits, ties to even
+        const float clamped = juce::jmin(magnitude, 65504.0f);
+        std::memcpy(&bits, &clamped, sizeof(float));
+        bits -= 112u << 23;
+        bits += 0xfffu + ((bits >> 13) & 1u);
+        output = (GrainHalf)(sign | (bits >> 13));
+    }
+}
+
+void GrainSource::fillGuards(float* data, int numSamples)
+{
+    // Grains wrap around the sample end in every loop mode, so the guards are
+    // wrapped copies (repeated for sources shorter than the guard)
+    for (int i = 1; i <= guardSamples; ++i)
+    {
+        data[-i] = data[(numSamples - (i % numSamples)) % numSamples];
+        data[numSamples - 1 + i] = data[(i - 1) % numSamples];
+    }
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include <JuceHeader.h>
+#include "GrainPageCache.h"
+#include "GrainSpan.h"
+
+// Loaded sample as the grain kernels see it
+// Mono or stereo (further channels are dropped); stereo is stored interleaved
+// as L/R frames so a grain reads both channels from one index in one stream.
+// Guard frames on both sides hold wrapped copies of the opposite end, so
+// interpolators can read a few frames past either edge without bounds checks
+// and reads across the loop seam stay continuous.
+//
+// Level 0 is the sample itself. Levels 1.. are band-limited half-rate copies
+// (a mip pyramid) built later by buildPyramid() on a background thread, so
+// grains pitched up by an octave or more can read a level where they step
+// through roughly one sample per output sample instead of skipping (aliasing).
+//
+// Resident sources can be stored as 16-bit integers or half floats instead of
+// float, halving memory and read bandwidth; the kernels widen as they read.
+//
+// Samples too large to decode up front stream instead: level 0 is then paged
+// in from disk by a GrainPageCache (as float) and there is no pyramid. Readers
+// go through pages either way; a resident source is a single page per level.
+//
+// Reference counted so the loader and a pyramid build can share it; the audio
+// thread only ever holds raw pointers (see GrainSourceLoader).
+class GrainSource : public juce::ReferenceCountedObject {
+public:
+    using Ptr = juce::ReferenceCountedObjectPtr<GrainSource>;
+    
+    // Enough for the widest interpolator on either side
+    static constexpr int guardSamples = 16;
+    
+    // Level 0 plus up to five octaves down (32x)
+    static constexpr int maxLevels = 6;
+    
+    GrainSource(const juce::AudioBuffer<float>& source, double sampleRate, juce::uint32 serialNumber = 0,
+                GrainSampleFormat format = grainSampleFloat32);
+    
+    // Streaming source reading from reader through a cache of cacheBudgetBytes
+    GrainSource(std::unique_ptr<juce::AudioFormatReader> reader, size_t cacheBudgetBytes, juce::uint32 serialNumber = 0);
+    
+    int getNumChannels() const { return numChannels; }
+    int getNumSamples(int level = 0) const { return levels[(size_t)level].numSamples; }
+    double getSampleRate() const { return sampleRate; }
+    GrainSampleFormat getSampleFormat() const { return format; }
+    int getBytesPerFrame() const { return grainSampleBytes(format) * numChannels; }
+    
+    // Increases with every load, so older sources compare lower
+    juce::uint32 getSerialNumber() const { return serialNumber; }
+    
+    // Resident sources only. Points at frame 0 of the level, in the source's
+    // sample format; frames -guardSamples .. numSamples + guardSamples - 1 are readable.
+    const void* getReadPointer(int level = 0) const {
+        jassert(!isStreaming());
+        return levels[(size_t)level].storage.get() + guardSamples * getBytesPerFrame();
+    }
+    
+    // Paged access, for resident and streaming sources alike. A page's pointer is
+    // its first frame, with guardSamples frames readable on either side; nullptr
+    // while a streamed page isn't resident. Only valid until endBlock().
+    bool isStreaming() const { return pageCache != nullptr; }
+    int getPageLength(int level = 0) const { return isStreaming() ? GrainPageCache::pageLength : getNumSamples(level); }
+    const void* getPageReadPointer(int level, int page) const {
+        return isStreaming() ? pageCache->getPage(page) : getReadPointer(level);
+    }
+    
+    // Audio thread. Streaming sources need every block that reads pages bracketed,
+    // and the samples grains are about to read requested ahead of time.
+    void beginBlock() const { if (isStreaming()) pageCache->beginBlock(); }
+    void endBlock() const { if (isStreaming()) pageCache->endBlock(); }
+    void prefetch(int firstSample, int numSamplesToRead) const { if (isStreaming()) pageCache->markWanted(firstSample, numSamplesToRead); }
+    bool isResident(int sample) const { return !isStreaming() || pageCache->getPage(sample / GrainPageCache::pageLength) != nullptr; }
+    void countMiss() const { if (isStreaming()) pageCache->countMiss(); }
+    
+    // Loader thread: brings in wanted pages; false when there is nothing to do
+    bool servicePageCache() { return isStreaming() && pageCache->service(); }
+    
+    // Levels published so far (at least 1); only grows, safe to call from the audio thread
+    int getNumLevels() const { return numReadyLevels.load(std::memory_order_acquire); }
+    
+    // Deepest ready level whose step stays at or above one sample for this increment
+    int getLevelForIncrement(float increment) const;
+    
+    // Builds levels 1.. until the next one would exceed budgetBytes of extra memory.
+    // Not real-time safe: run on a background thread. Each level is published once complete.
+    void buildPyramid(size_t budgetBytes, const std::function<bool()>& shouldStop);
+    
+    // Memory held by the levels built so far, level 0 included
+    size_t getMemoryBytes() const;
+    
+    // Float to the compact formats. int16 clips at full scale; halves round to
+    // nearest, clamp to the largest finite half and flush below the smallest
+    // normal one (about -84 dBFS), which keeps decoding exact and branch-free.
+    // destinationStride steps between written samples (2 fills one channel of interleaved stereo).
+    static void encodeSamples(const float* source, int16_t* destination, int numSamples, int destinationStride = 1);
+    static void encodeSamples(const float* source, GrainHalf* destination, int numSamples, int destinationStride = 1);
+
+private:
+    struct Level {
+        juce::HeapBlock<char> storage; // Frames, guards included
+        int numSamples = 0;
+    };
+    
+    std::array<Level, maxLevels> levels;
+    std::unique_ptr<GrainPageCache> pageCache;
+    std::atomic<int> numReadyLevels { 0 };
+    int numChannels = 0;
+    double sampleRate = 44100.0;
+    juce::uint32 serialNumber = 0;
+    GrainSampleFormat format = grainSampleFloat32;
+    
+    void allocateLevel(int level, int numSamples);
+    
+    // One channel of a level as float, guards included, and back (copies unless the source is float mono)
+    const float* decodeChannel(int level, int channel, std::vector<float>& scratch) const;
+    void encodeChannel(int level, int channel, const float* samples);
+    
+    size_t getLevelBytes(int numSamples) const;
+    static void fillGuards(float* data, int numSamples);
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GrainSource)
+};
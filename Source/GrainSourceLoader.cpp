@@ -0,0 +1,162 @@
+#include "GrainSourceLoader.h"
+#include "GrainResampler.h"
+
+namespace {
+    // How often released sources are checked for when nothing is loading
+    constexpr int reclaimIntervalMs = 500;
+    
+    // While a source streams: how often its cache is serviced, and how many pages per pass
+    constexpr int streamIntervalMs = 5;
+    constexpr int pagesPerPass = 16;
+}
+
+GrainSourceLoader::GrainSourceLoader()
+    : juce::Thread("Grain source loader")
+{
+    startThread(juce::Thread::Priority::background);
+}
+
+GrainSourceLoader::~GrainSourceLoader()
+{
+    signalThreadShouldExit();
+    notify();
+    stopThread(10000);
+}
+
+juce::Result GrainSourceLoader::loadAsync(std::unique_ptr<juce::AudioFormatReader> reader, double targetSampleRate, size_t pyramidBudgetBytes,
+                                          GrainSampleFormat format, size_t streamingThresholdBytes, size_t streamCacheBytes)
+{
+    // Frames are addressed with int throughout
+    if (reader->lengthInSamples <= 0)
+        return juce::Result::fail("The sample is empty");
+    if (reader->lengthInSamples > std::numeric_limits<int>::max())
+        return juce::Result::fail("The sample is too long (more than " + juce::String(std::numeric_limits<int>::max()) + " frames)");
+        
+    auto request = std::make_unique<Request>();
+    request->reader = std::move(reader);
+    request->targetSampleRate = targetSampleRate;
+    request->pyramidBudgetBytes = pyramidBudgetBytes;
+    request->format = format;
+    request->streamingThresholdBytes = streamingThresholdBytes;
+    request->streamCacheBytes = streamCacheBytes;
+    
+    {
+        const juce::ScopedLock sl(requestLock);
+        pending = std::move(request);
+        hasPending.store(true, std::memory_order_release);
+    }
+    notify();
+    return juce::Result::ok();
+}
+
+void GrainSourceLoader::acknowledge(const GrainSource* oldestInUse, const GrainSource* latestSeen)
+{
+    // latestSeen may not be adopted yet, but this block could still touch it
+    juce::uint32 serial = latestSeen != nullptr ? latestSeen->getSerialNumber() : 0;
+    if (oldestInUse != nullptr)
+        serial = juce::jmin(serial, oldestInUse->getSerialNumber());
+    acknowledgedSerial.store(serial, std::memory_order_release);
+}
+
+void GrainSourceLoader::run()
+{
+    while (!threadShouldExit())
+    {
+        std::unique_ptr<Request> request;
+        {
+            const juce::ScopedLock sl(requestLock);
+            request = std::move(pending);
+            hasPending.store(false, std::memory_order_relaxed);
+        }
+        
+        if (request != nullptr)
+            load(*request);
+            
+        reclaim();
+        updateMemoryBytes();
+        const bool streaming = serviceStreams();
+        
+        if (!hasPending.load(std::memory_order_acquire))
+            wait(streaming ? streamIntervalMs : reclaimIntervalMs);
+    }
+}
+
+void GrainSourceLoader::load(Request& request)
+{
+    auto& reader = *request.reader;
+    
+    // Refused by loadAsync
+    jassert(reader.lengthInSamples > 0 && reader.lengthInSamples <= std::numeric_limits<int>::max());
+    
+    const auto decodedBytes = (size_t)reader.lengthInSamples * juce::jmax(1u, reader.numChannels) * sizeof(float);
+    if (decodedBytes > request.streamingThresholdBytes)
+    {
+        GrainSource::Ptr source = new GrainSource(std::move(request.reader), request.streamCacheBytes, ++lastSerial);
+        sources.add(source);
+        published.store(source.get(), std::memory_order_release);
+        return;
+    }
+    
+    const auto shouldStop = [this] {
+        return threadShouldExit() || hasPending.load(std::memory_order_acquire);
+    };
+    
+    juce::AudioBuffer<float> decoded((int)juce::jmax(1u, reader.numChannels), (int)reader.lengthInSamples);
+    reader.read(&decoded, 0, (int)reader.lengthInSamples, 0, true, true);
+    double sampleRate = reader.sampleRate;
+    
+    if (shouldStop())
+        return;
+        
+    // Converted once here rather than by every grain's step
+    if (sampleRate > 0.0 && request.targetSampleRate > 0.0 && request.targetSampleRate != sampleRate)
+    {
+        decoded = GrainResampler::convert(decoded, sampleRate, request.targetSampleRate, shouldStop);
+        sampleRate = request.targetSampleRate;
+        
+        if (shouldStop())
+            return;
+    }
+    
+    GrainSource::Ptr source = new GrainSource(decoded, sampleRate, ++lastSerial, request.format);
+    sources.add(source);
+    published.store(source.get(), std::memory_order_release);
+    
+    // Grains play from the full-rate copy until the octave-down levels are published
+    source->buildPyramid(request.pyramidBudgetBytes, shouldStop);
+}
+
+void GrainSourceLoader::reclaim()
+{
+    // The published source always has the newest serial, so it is never released here
+    const auto oldestInUse = acknowledgedSerial.load(std::memory_order_acquire);
+    for (int i = sources.size(); --i >= 0;)
+        if (sources.getObjectPointerUnchecked(i)->getSerialNumber() < oldestInUse)
+            sources.remove(i);
+}
+
+void GrainSourceLoader::updateMemoryBytes()
+{
+    size_t bytes = 0;
+    for (auto* source : sources)
+        bytes += source->getMemoryBytes();
+    memoryBytes.store(bytes, std::memory_order_relaxed);
+}
+
+bool GrainSourceLoader::serviceStreams()
+{
+    bool anyStreaming = false;
+    
+    for (auto* source : sources)
+    {
+        if (!source->isStreaming())
+            continue;
+            
+        anyStreaming = true;
+        for (int i = 0; i < pagesPerPass && !threadShouldExit() && !hasPending.load(std::memory_order_acquire); ++i)
+            if (!source->servicePageCache())
+                break;
+    }
+    
+    return anyStreaming;
+}
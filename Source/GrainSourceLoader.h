@@ -0,0 +1,76 @@
+#pragma once
+#include <JuceHeader.h>
+#include "GrainSource.h"
+
+// Decodes samples off the message thread and hands them to the audio thread
+// Each loaded GrainSource is immutable apart from its pyramid levels, which
+// publish themselves atomically. The newest source is published through an
+// atomic pointer the audio thread reads without locking. The loader keeps every
+// source alive until the audio thread has acknowledged that it no longer reads
+// it. Sources carry increasing serial numbers, and the audio thread reports the
+// oldest one it may still touch; anything older is released here, on the
+// loader thread, never on the audio thread.
+//
+// Resident samples are converted to the session rate as they load (see
+// GrainResampler), so unpitched grains step exactly one frame per output sample.
+//
+// Samples whose decoded size exceeds the streaming threshold are not decoded:
+// their source streams from the reader at the file's rate, and this thread
+// keeps servicing its page cache for as long as it is alive.
+class GrainSourceLoader : private juce::Thread {
+public:
+    GrainSourceLoader();
+    ~GrainSourceLoader() override;
+    
+    // Message thread. Takes over the reader; decoding and the pyramid build
+    // happen on the loader thread. A newer request cancels an unfinished one.
+    // Fails, without queuing anything, for a sample the source can't address
+    // (empty, or more than INT_MAX frames), so the caller can report it.
+    // Resident samples are resampled to targetSampleRate (0 keeps the file's
+    // rate) and stored in format. Samples larger than streamingThresholdBytes
+    // decoded stream through a cache of streamCacheBytes instead (always as
+    // float, at the file's rate).
+    juce::Result loadAsync(std::unique_ptr<juce::AudioFormatReader> reader, double targetSampleRate, size_t pyramidBudgetBytes,
+                           GrainSampleFormat format, size_t streamingThresholdBytes, size_t streamCacheBytes);
+    
+    // Any thread: the newest published source, or nullptr. Off the audio thread
+    // only compare or null-check it; it can be released once it is superseded.
+    const GrainSource* getPublished() const { return published.load(std::memory_order_acquire); }
+    
+    // Audio thread, once per block: the oldest source the engine can still read
+    // (nullptr if none) and the published source it read this block
+    void acknowledge(const GrainSource* oldestInUse, const GrainSource* latestSeen);
+    
+    // Any thread: memory held by every source not yet released, pyramids and stream caches included
+    size_t getMemoryBytes() const { return memoryBytes.load(std::memory_order_relaxed); }
+
+private:
+    struct Request {
+        std::unique_ptr<juce::AudioFormatReader> reader;
+        double targetSampleRate = 0.0;
+        size_t pyramidBudgetBytes = 0;
+        GrainSampleFormat format = grainSampleFloat32;
+        size_t streamingThresholdBytes = 0;
+        size_t streamCacheBytes = 0;
+    };
+    
+    void run() override;
+    void load(Request& request);
+    void reclaim();
+    bool serviceStreams();
+    void updateMemoryBytes();
+    
+    juce::CriticalSection requestLock; // Guards pending; never taken by the audio thread
+    std::unique_ptr<Request> pending;
+    std::atomic<bool> hasPending { false };
+    
+    // Loader thread only
+    juce::ReferenceCountedArray<GrainSource> sources;
+    juce::uint32 lastSerial = 0;
+    
+    std::atomic<const GrainSource*> published { nullptr };
+    std::atomic<juce::uint32> acknowledgedSerial { 0 }; // Sources below this are unused
+    std::atomic<size_t> memoryBytes { 0 };
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GrainSourceLoader)
+};
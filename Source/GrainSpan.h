@@ -0,0 +1,90 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+// Plain data shared by the scalar and SIMD grain kernels.
+// Kept free of JUCE includes so the per-instruction-set kernel files can be
+// compiled with their own target flags without emitting shared inline code.
+
+// Must match GrainWindows::tableSize
+constexpr int grainWindowTableSize = 1024;
+
+// Interpolation quality, cheapest first
+enum GrainInterpolation {
+    grainInterpolationLinear,
+    grainInterpolationCubic,   // 4-point Hermite
+    grainInterpolationSinc,    // Polyphase windowed sinc
+    grainInterpolationDirect,  // Whole frames at a step of exactly one; picked per grain, not a quality setting
+    numGrainInterpolations
+};
+
+// How a source stores its samples; kernels widen to float as they read
+enum GrainSampleFormat {
+    grainSampleFloat32,
+    grainSampleInt16,     // Full scale is 32768
+    grainSampleFloat16,   // IEEE half bit patterns, never subnormal (see GrainSource)
+    numGrainSampleFormats
+};
+
+using GrainHalf = uint16_t;
+
+static constexpr int grainSampleBytes(int format) {
+    return format == grainSampleFloat32 ? (int)sizeof(float) : (int)sizeof(int16_t);
+}
+
+// Widening reads. Both are exact, so scalar and vector kernels agree bit for bit.
+static inline float grainSampleToFloat(float sample) { return sample; }
+static inline float grainSampleToFloat(int16_t sample) { return (float)sample * (1.0f / 32768.0f); }
+
+// Moves the half's exponent and mantissa into float position and rebiases by
+// multiplying with 2^112; exact for zero and normal halves
+static inline float grainSampleToFloat(GrainHalf sample) {
+    const uint32_t magnitudeBits = (uint32_t)(sample & 0x7fffu) << 13;
+    float magnitude;
+    std::memcpy(&magnitude, &magnitudeBits, sizeof(float));
+    magnitude *= 0x1.0p112f;
+    
+    uint32_t bits;
+    std::memcpy(&bits, &magnitude, sizeof(float));
+    bits |= (uint32_t)(sample & 0x8000u) << 16;
+    float result;
+    std::memcpy(&result, &bits, sizeof(float));
+    return result;
+}
+
+// Polyphase sinc table layout: (grainSincPhases + 1) rows of grainSincTaps coefficients.
+// Row p holds the taps for a fractional position of p / grainSincPhases; the extra row
+// lets kernels interpolate between neighbouring phases without a wrap.
+// Tap k multiplies source[index - grainSincTaps / 2 + 1 + k].
+constexpr int grainSincTaps = 16;
+constexpr int grainSincPhases = 256;
+
+// One contiguous run of a grain that is known to stay inside the source,
+// so kernels can read without bounds checks or wrap handling.
+// The source pointer is rebased so that every read position in the span is
+// non-negative and relative to it. It points at frames in the format the
+// kernel was selected for: one sample each for mono, an interleaved L/R pair
+// for stereo, so one index reaches both channels in a single cache stream.
+struct GrainSpan {
+    const void* source = nullptr;
+    float position = 0.0f;            // Read position (in frames) of the first sample, relative to the source pointer
+    float increment = 1.0f;           // Source samples per output sample (always positive)
+    const float* window = nullptr;
+    float phase = 0.0f;               // Window phase of the first sample
+    float phaseIncrement = 0.0f;
+    float gainL = 1.0f, gainR = 1.0f; // Pan and per-grain amplitude
+    float* mixL = nullptr;
+    float* mixR = nullptr;
+    int numSamples = 0;
+    const float* sincTable = nullptr; // Only read by the sinc kernels
+};
+
+using GrainKernel = void (*)(const GrainSpan&);
+
+// Kernel tables are indexed by the grain configuration
+// (static: each kernel file gets its own copy, compiled with its own flags)
+constexpr int numGrainKernels = 8 * numGrainInterpolations * numGrainSampleFormats;
+
+static constexpr int grainKernelIndex(int format, int interpolation, bool reverse, bool stereo, bool windowed) {
+    return (format * numGrainInterpolations + interpolation) * 8 + ((reverse ? 4 : 0) | (stereo ? 2 : 0) | (windowed ? 1 : 0));
+}
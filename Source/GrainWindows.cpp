@@ -0,0 +1,46 @@
+#include "GrainWindows.h"
+#include <cmath>
+
+const GrainWindows& GrainWindows::getInstance()
+{
+    static const GrainWindows instance;
+    return instance;
+}
+
+GrainWindows::GrainWindows()
+{
+    for (int shape = 0; shape < numShapes; ++shape)
+        for (int i = 0; i < tableSize + 2; ++i)
+            tables[(size_t)shape][(size_t)i] = evaluate(shape, juce::jmin(1.0f, (float)i / (float)tableSize));
+}
+
+float GrainWindows::evaluate(int shape, float x)
+{
+    const float pi = juce::MathConstants<float>::pi;
+    
+    switch (shape) {
+        case hann:
+            return 0.5f - 0.5f * std::cos(2.0f * pi * x);
+        case triangle:
+            return (x < 0.5f) ? (2.0f * x) : (2.0f * (1.0f - x));
+        case square: // No envelope
+            return 1.0f;
+        case gauss:
+            {
+                const float g = (x - 0.5f) * 4.0f; // Scale to -2 to 2
+                return std::exp(-g * g);
+            }
+        case trapezoid: // Linear 25% ramps with a flat top
+            return juce::jmin(1.0f, 4.0f * juce::jmin(x, 1.0f - x));
+        case tukey: // Cosine-tapered, alpha = 0.5
+            {
+                const float alpha = 0.5f;
+                const float edge = juce::jmin(x, 1.0f - x);
+                if (edge >= alpha * 0.5f)
+                    return 1.0f;
+                return 0.5f - 0.5f * std::cos(2.0f * pi * edge / alpha);
+            }
+        default:
+            return 0.5f - 0.5f * std::cos(2.0f * pi * x);
+    }
+}
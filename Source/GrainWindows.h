@@ -0,0 +1,45 @@
+#pragma once
+#include <JuceHeader.h>
+#include "GrainSpan.h"
+
+// Precomputed grain window shapes
+// Grains step a 0-1 phase through these tables instead of evaluating
+// transcendental functions per sample.
+class GrainWindows {
+public:
+    enum Shape {
+        hann = 0,
+        triangle,
+        square,
+        gauss,
+        trapezoid,
+        tukey,
+        numShapes
+    };
+    
+    static constexpr int tableSize = grainWindowTableSize;
+    
+    // Tables are built on first use; call from prepare() so the audio thread never builds them
+    static const GrainWindows& getInstance();
+    
+    const float* getTable(int shape) const {
+        return tables[(size_t)juce::jlimit(0, (int)numShapes - 1, shape)].data();
+    }
+    
+    // Linear interpolation; phase may overshoot 1.0 slightly from accumulated increments
+    static float lookup(const float* table, float phase) {
+        const float index = juce::jlimit(0.0f, (float)tableSize, phase * (float)tableSize);
+        const int i = (int)index;
+        const float frac = index - (float)i;
+        return table[i] + frac * (table[i + 1] - table[i]);
+    }
+    
+    float getValue(int shape, float phase) const { return lookup(getTable(shape), phase); }
+    
+private:
+    GrainWindows();
+    static float evaluate(int shape, float x);
+    
+    // One guard point past phase 1.0 so lookup() can always read i + 1
+    std::array<std::array<float, tableSize + 2>, numShapes> tables;
+};
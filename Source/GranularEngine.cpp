@@ -1,4 +1,5 @@
 #include "GranularEngine.h"
+#include <algorithm>
 #include <cmath>
 
 void GranularVoice::prepare(double sampleRate, int maximumBlockSize)
@@ -16,16 +17,41 @@ void GranularVoice::prepare(double sampleRate, int maximumBlockSize)
     filterL.coefficients = juce::dsp::IIR::Coefficients<float>::makeLowPass(sampleRate, 20000.0f, 0.7f);
     filterR.coefficients = juce::dsp::IIR::Coefficients<float>::makeLowPass(sampleRate, 20000.0f, 0.7f);
     
-    // Initialize chorus delay lines
+    // Parameter smoothing, starting settled on the current values
+    positionRamp.prepare(sampleRate, maximumBlockSize, 0.03, ParameterRamp::Shape::linear);
+    cutoffRamp.prepare(sampleRate, maximumBlockSize, 0.02, ParameterRamp::Shape::onePole);
+    positionRamp.setCurrentAndTarget(parameters.position);
+    cutoffRamp.setCurrentAndTarget(parameters.filterCutoff);
+    
+    // Initialize chorus delay lines (mono each)
+    chorusDelayL.prepare({ sampleRate, (juce::uint32)maximumBlockSize, 1 });
+    chorusDelayR.prepare({ sampleRate, (juce::uint32)maximumBlockSize, 1 });
     chorusDelayL.reset();
     chorusDelayR.reset();
     chorusLFOPhase = 0.0f;
+    
+    // Unseeded notes still differ between instances and sessions
+    freeRunningKey = (juce::uint32)juce::Random::getSystemRandom().nextInt();
+    
+    // Window tables are shared by all voices; building them here keeps it off the audio thread
+    windows = &GrainWindows::getInstance();
+    GrainKernels::initialise();
+    
+    // Scratch accumulator for grain-major rendering
+    grainMixBuffer.setSize(2, juce::jmax(1, maximumBlockSize));
+    
+    // All grain storage is allocated here, never on the audio thread
+    activeGrains.allocate(grainPoolCapacity);
+    
+    // Derived state for the current parameters at the new sample rate
+    updateInternalParams();
 }
 
-void GranularVoice::setAudioSource(const juce::AudioBuffer<float>* source, double sourceRate)
+void GranularVoice::setAudioSource(const GrainSource* source)
 {
     audioSource = source;
-    this->sourceSampleRate = sourceRate;
+    if (source != nullptr)
+        sourceSampleRate = source->getSampleRate();
 }
 
 void GranularVoice::startNote(int midiNoteNumber, float noteVelocity, juce::SynthesiserSound*, int currentPitchWheelPosition)
@@ -35,6 +61,29 @@ void GranularVoice::startNote(int midiNoteNumber, float noteVelocity, juce::Synt
     this->midiNote = midiNoteNumber;
     this->velocity = noteVelocity;
     this->isActive = true;
+    this->noteReleased = false;
+    
+    // A seeded note replays exactly: its random stream depends only on the seed and the
+    // key, and nothing the voice played before carries over (modulation, glide, spawn
+    // timing, envelope, filter and chorus all restart). Unseeded notes each get a new stream.
+    if (parameters.seed > 0.0f)
+    {
+        random.setKey(GrainRandom::mix((juce::uint32)parameters.seed * 0x9e3779b9u ^ (juce::uint32)midiNoteNumber));
+        lfoPhase = lfo2Phase = scanPhase = 0.0f;
+        scanDirection = 1.0f;
+        currentPlayPosition = parameters.position;
+        nextGrainTime = jitterAccumulator = 0.0f;
+        envelope.reset();
+        filterL.reset();
+        filterR.reset();
+        chorusDelayL.reset();
+        chorusDelayR.reset();
+        chorusLFOPhase = 0.0f;
+    }
+    else
+    {
+        random.setKey(GrainRandom::mix(++freeRunningKey));
+    }
     
     // Start envelope
     envelope.noteOn();
@@ -45,9 +94,15 @@ void GranularVoice::startNote(int midiNoteNumber, float noteVelocity, juce::Synt
     // Reset grain spawn timer
     grainSpawnTimer = 0.0f;
     
-    // Spawn fewer initial grains for better performance
-    for (int i = 0; i < 2; ++i)
-        spawnGrain();
+    // Idle voices don't advance their ramps, so a new note starts settled
+    positionRamp.setCurrentAndTarget(parameters.position);
+    cutoffRamp.setCurrentAndTarget(parameters.filterCutoff);
+    updateFilterCoefficients(parameters.filterCutoff);
+    
+    // Spawn fewer initial grains for better performance. They start with the next render,
+    // after the engine has handed out this block's budget slots (a note can also start
+    // outside render, through GranularEngine::noteOn).
+    numInitialGrains = 2;
 }
 
 void GranularVoice::stopNote(float noteOffVelocity, bool allowTailOff)
@@ -57,22 +112,33 @@ void GranularVoice::stopNote(float noteOffVelocity, bool allowTailOff)
     if (allowTailOff)
     {
         envelope.noteOff();
+        noteReleased = true;
     }
     else
     {
         envelope.reset();
         isActive = false;
         activeGrains.clear();
+        numInitialGrains = 0;
     }
 }
 
 void GranularVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
 {
-    if (!isActive || !audioSource || audioSource->getNumSamples() == 0)
+    if (!isActive || !audioSource || audioSource->getNumSamples() == 0 || grainMixBuffer.getNumSamples() == 0 || windows == nullptr)
         return;
         
-    // Update grain spawning
-    updateGrains(outputBuffer, startSample, numSamples);
+    for (; numInitialGrains > 0; --numInitialGrains)
+        spawnGrain();
+    
+    // Render in chunks that fit the scratch buffer (hosts may exceed the prepared block size)
+    while (numSamples > 0)
+    {
+        const int blockSize = juce::jmin(numSamples, grainMixBuffer.getNumSamples());
+        updateGrains(outputBuffer, startSample, blockSize);
+        startSample += blockSize;
+        numSamples -= blockSize;
+    }
     
     // Check if envelope has finished
     if (!envelope.isActive() && activeGrains.empty())
@@ -82,126 +148,357 @@ void GranularVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int
     }
 }
 
+void GranularVoice::setParameters(const GranularParams& newParams)
+{
+    // Recompute derived state only for the fields that changed
+    const bool envelopeChanged = newParams.attack != parameters.attack || newParams.decay != parameters.decay
+                              || newParams.sustain != parameters.sustain || newParams.release != parameters.release;
+    const bool densityChanged = newParams.density != parameters.density;
+    const bool resonanceChanged = newParams.filterRes != parameters.filterRes;
+    
+    parameters = newParams;
+    
+    // Automated values glide over the next blocks instead of stepping
+    positionRamp.setTarget(parameters.position);
+    cutoffRamp.setTarget(parameters.filterCutoff);
+    
+    if (envelopeChanged)
+        updateEnvelopeParams();
+    if (densityChanged)
+        grainSpawnInterval = 1.0f / juce::jmax(0.1f, parameters.density * 100.0f);
+    if (resonanceChanged && !cutoffRamp.isSmoothing())
+        updateFilterCoefficients(cutoffRamp.getCurrentValue());
+}
+
+// Full recompute, for prepare() and sample rate changes
 void GranularVoice::updateInternalParams()
 {
-    // Update envelope parameters
+    updateEnvelopeParams();
+    
+    // Update grain spawn interval based on density
+    grainSpawnInterval = 1.0f / juce::jmax(0.1f, parameters.density * 100.0f);
+    
+    updateFilterCoefficients(cutoffRamp.getCurrentValue());
+}
+
+void GranularVoice::updateEnvelopeParams()
+{
     envelopeParams.attack = parameters.attack / 1000.0f;
     envelopeParams.decay = parameters.decay / 1000.0f;
     envelopeParams.sustain = parameters.sustain;
     envelopeParams.release = parameters.release / 1000.0f;
     envelope.setParameters(envelopeParams);
+}
+
+void GranularVoice::updateFilterCoefficients(float cutoff)
+{
+    const float cutoffHz = juce::jmap(cutoff, 0.0f, 1.0f, 80.0f, 20000.0f);
+    const float resonance = juce::jmap(parameters.filterRes, 0.0f, 1.0f, 0.5f, 10.0f);
     
-    // Update grain spawn interval based on density
-    grainSpawnInterval = 1.0f / juce::jmax(0.1f, parameters.density * 100.0f);
+    // Written into the coefficient objects made in prepare(), so nothing is allocated here
+    const auto coefficients = juce::dsp::IIR::ArrayCoefficients<float>::makeLowPass(currentSampleRate, cutoffHz, resonance);
+    *filterL.coefficients = coefficients;
+    *filterR.coefficients = coefficients;
+}
+
+void GranularVoice::updateGrains(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    numSamples = juce::jmin(numSamples, buffer.getNumSamples() - startSample);
+    if (numSamples <= 0)
+        return;
+        
+    // Spawns are scheduled first at their sample offsets inside the block,
+    // each reading the smoothed position at its own offset
+    blockPositions = positionRamp.process(numSamples);
+    if (audioSource->isStreaming())
+        prefetchSpawnWindow();
+        
+    scheduleGrainSpawns(numSamples);
+    blockPositions = nullptr;
+    
+    // Grain-major pass: each grain renders its whole span into the scratch accumulator
+    grainMixBuffer.clear(0, numSamples);
+    float* mixL = grainMixBuffer.getWritePointer(0);
+    float* mixR = grainMixBuffer.getWritePointer(1);
+    
+    for (auto& grain : activeGrains)
+        renderGrain(grain, mixL, mixR, numSamples);
+        
+    // Retire finished grains in a single pass
+    activeGrains.removeIf([](const Grain& g) { return g.samplesRemaining <= 0; });
+    
+    // Apply voice envelope and velocity
+    const float voiceGain = velocity * 0.3f; // Scale down more for performance
     
-    // Update filter coefficients
-    float cutoffHz = juce::jmap(parameters.filterCutoff, 0.0f, 1.0f, 80.0f, 20000.0f);
-    float resonance = juce::jmap(parameters.filterRes, 0.0f, 1.0f, 0.5f, 10.0f);
+    // While the cutoff glides, coefficients follow it every filterUpdateInterval samples
+    const bool filterEngaged = parameters.filterCutoff < 1.0f || cutoffRamp.isSmoothing();
+    const float* cutoffs = cutoffRamp.isSmoothing() ? cutoffRamp.process(numSamples) : nullptr;
+    
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        envelopeLevel = envelope.getNextSample();
+        float outputL = mixL[sample] * envelopeLevel * voiceGain;
+        float outputR = mixR[sample] * envelopeLevel * voiceGain;
+        
+        // Apply filter
+        if (cutoffs != nullptr && sample % filterUpdateInterval == 0)
+            updateFilterCoefficients(cutoffs[sample]);
+        if (filterEngaged)
+            processFilter(outputL, outputR);
+        
+        // Apply chorus for widening
+        processChorus(outputL, outputR);
+        
+        mixL[sample] = outputL;
+        mixR[sample] = outputR;
+    }
     
-    auto coefficients = juce::dsp::IIR::Coefficients<float>::makeLowPass(currentSampleRate, cutoffHz, resonance);
-    filterL.coefficients = coefficients;
-    filterR.coefficients = coefficients;
+    if (cutoffs != nullptr && !cutoffRamp.isSmoothing())
+        updateFilterCoefficients(cutoffRamp.getTargetValue());
+        
+    // Add to output buffer
+    buffer.addFrom(0, startSample, grainMixBuffer, 0, 0, numSamples);
+    if (buffer.getNumChannels() > 1)
+        buffer.addFrom(1, startSample, grainMixBuffer, 1, 0, numSamples);
 }
 
-void GranularVoice::updateGrains(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+void GranularVoice::scheduleGrainSpawns(int numSamples)
 {
-    const float samplesPerSec = (float)currentSampleRate;
     const float grainSpawnRate = parameters.density * 50.0f; // Reduced from 100 to 50 for better performance
-    const float spawnIncrement = grainSpawnRate / samplesPerSec;
+    const float spawnIncrement = grainSpawnRate / (float)currentSampleRate;
     
-    for (int sample = 0; sample < numSamples; ++sample)
+    if (spawnIncrement <= 0.0f || !isActive)
+        return;
+        
+    // Jump straight to each sample where the spawn timer crosses 1.0 instead of ticking per sample
+    int offset = 0;
+    for (;;)
     {
-        const int bufferIndex = startSample + sample;
+        const int steps = juce::jmax(1, (int)std::ceil((1.0f - grainSpawnTimer) / spawnIncrement));
+        if (offset + steps > numSamples)
+        {
+            grainSpawnTimer += (float)(numSamples - offset) * spawnIncrement;
+            break;
+        }
         
-        // Spawn new grains based on density (with stricter CPU limit)
-        if (activeGrains.size() < 16) // Further reduced from 24 to 16 for better CPU performance
+        offset += steps;
+        grainSpawnTimer += (float)steps * spawnIncrement - 1.0f;
+        spawnGrain(offset - 1);
+    }
+}
+
+bool GranularVoice::usesSource(const GrainSource* source) const
+{
+    for (const auto& grain : activeGrains)
+        if (grain.source == source)
+            return true;
+    return false;
+}
+
+// Requests the pages new grains can start from: the position with scan, spray and
+// LFO reach, widened by the longest grain
+void GranularVoice::prefetchSpawnWindow()
+{
+    const float length = (float)audioSource->getNumSamples();
+    float centre = (positionRamp.getCurrentValue() + (parameters.scan > 0.01f ? scanPhase : 0.0f)) * length;
+    if ((int)parameters.loopMode == 1)
+        centre = length - centre;
+    const float spray = juce::jmax(parameters.texture, parameters.spray) * 0.2f;
+    const float lfoReach = parameters.lfoTarget == 0.0f ? parameters.lfoAmount * 0.3f : 0.0f;
+    const float grainReach = 2.0f * (float)currentSampleRate * std::pow(2.0f, juce::jmax(0.0f, parameters.pitch + parameters.grainPitch) / 12.0f);
+    const float radius = (spray + lfoReach) * length + grainReach;
+    audioSource->prefetch((int)(centre - radius), (int)(2.0f * radius));
+}
+
+// Makes room for one more grain: space in the pool, and a slot from the engine budget.
+// A grain evicted from a full pool gives its slot back before the new one takes one.
+bool GranularVoice::admitGrain()
+{
+    if (activeGrains.isFull())
+    {
+        activeGrains.remove(findLeastAudibleGrain());
+        if (grainBudget != nullptr)
         {
-            grainSpawnTimer += spawnIncrement;
-            while (grainSpawnTimer >= 1.0f && isActive)
-            {
-                spawnGrain();
-                grainSpawnTimer -= 1.0f;
-            }
+            grainBudget->addCulled(1);
+            grainBudget->releaseSlot();
         }
+    }
+    
+    return grainBudget == nullptr || grainBudget->tryAcquireSlot();
+}
+
+// Returns a slot from admitGrain() for a grain that didn't start after all
+void GranularVoice::releaseGrainSlot()
+{
+    if (grainBudget != nullptr)
+        grainBudget->releaseSlot();
+}
+
+// A held note is judged by where its envelope is heading, a released one by where it is
+float GranularVoice::getVoiceAudibility() const
+{
+    const float level = noteReleased ? envelopeLevel : juce::jmax(envelopeLevel, parameters.sustain);
+    return level * velocity;
+}
+
+// Rising grains count at their peak, falling ones at their current window value
+float GranularVoice::getGrainAudibility(const Grain& grain, float voiceAudibility) const
+{
+    const float window = grain.envelope < 0.5f ? 1.0f : windows->getValue(grain.shapeType, grain.envelope);
+    return window * grain.ampMultiplier * voiceAudibility;
+}
+
+int GranularVoice::getGrainAudibility(float* destination) const
+{
+    if (windows == nullptr)
+        return 0;
         
-        // Process all active grains
-        float outputL = 0.0f, outputR = 0.0f;
+    const float voiceAudibility = getVoiceAudibility();
+    for (int g = 0; g < activeGrains.size(); ++g)
+        destination[g] = getGrainAudibility(activeGrains[g], voiceAudibility);
+    return activeGrains.size();
+}
+
+int GranularVoice::cullGrains(float threshold, int& keepAtThreshold)
+{
+    if (windows == nullptr)
+        return 0;
         
-        for (int g = (int)activeGrains.size() - 1; g >= 0; --g)
+    const int before = activeGrains.size();
+    const float voiceAudibility = getVoiceAudibility();
+    activeGrains.removeIf([&](const Grain& grain) {
+        const float audibility = getGrainAudibility(grain, voiceAudibility);
+        if (audibility > threshold)
+            return false;
+        if (audibility == threshold && keepAtThreshold > 0)
         {
-            auto& grain = activeGrains[g];
-            
-            if (grain.samplesRemaining <= 0)
-            {
-                activeGrains.erase(activeGrains.begin() + g);
-                continue;
-            }
-            
-            // Skip processing very quiet grains for performance
-            float envelopePhase = 1.0f - (float)grain.samplesRemaining / (float)grain.totalSamples;
-            float envelopeValue = 0.5f - 0.5f * std::cos(2.0f * juce::MathConstants<float>::pi * envelopePhase);
-            if (envelopeValue < 0.02f) { // Increased threshold to skip more quiet grains
-                --grain.samplesRemaining;
-                continue; // Skip very quiet grains
-            }
-            
-            // Get sample from audio source with interpolation
-            float sampleL = getInterpolatedSample(0, grain.position);
-            float sampleR = audioSource->getNumChannels() > 1 ? 
-                           getInterpolatedSample(1, grain.position) : sampleL;
-            
-            // Use pre-calculated envelope value
-            
-            sampleL *= envelopeValue;
-            sampleR *= envelopeValue;
-            
-            // Apply panning
-            outputL += sampleL * grain.panL;
-            outputR += sampleR * grain.panR;
-            
-            // Update grain state
-            if (grain.reverse)
-                grain.position -= grain.increment;
-            else
-                grain.position += grain.increment;
-                
-            // Handle looping/boundaries
-            if (grain.position >= audioSource->getNumSamples())
-                grain.position = 0.0f;
-            else if (grain.position < 0.0f)
-                grain.position = (float)(audioSource->getNumSamples() - 1);
-                
-            --grain.samplesRemaining;
+            --keepAtThreshold;
+            return false;
+        }
+        return true;
+    });
+    return before - activeGrains.size();
+}
+
+int GranularVoice::findLeastAudibleGrain() const
+{
+    const float voiceAudibility = getVoiceAudibility();
+    int index = 0;
+    float quietest = getGrainAudibility(activeGrains[0], voiceAudibility);
+    for (int g = 1; g < activeGrains.size(); ++g)
+    {
+        const float audibility = getGrainAudibility(activeGrains[g], voiceAudibility);
+        if (audibility < quietest)
+        {
+            quietest = audibility;
+            index = g;
         }
+    }
+    return index;
+}
+
+void GranularVoice::renderGrain(Grain& grain, float* mixL, float* mixR, int numSamples)
+{
+    const int start = grain.startOffset;
+    const int count = juce::jmin(numSamples - start, grain.samplesRemaining);
+    grain.startOffset = 0;
+    
+    if (count <= 0 || grain.kernel == nullptr)
+        return;
+        
+    // Read from the pyramid level picked at spawn, working in that level's sample units
+    const auto& source = *grain.source;
+    const int level = juce::jmin(grain.level, source.getNumLevels() - 1);
+    const double levelScale = (double)(1 << level);
+    const int sourceLength = source.getNumSamples(level);
+    const int pageLength = source.getPageLength(level);
+    const int frameBytes = source.getBytesPerFrame();
+    const float* window = windows->getTable(grain.shapeType);
+    const float* sincTable = GrainKernels::getSincTable();
+    const float gainL = grain.panL * grain.ampMultiplier;
+    const float gainR = grain.panR * grain.ampMultiplier;
+    
+    const double increment = grain.increment / levelScale;
+    double position = grain.position / levelScale;
+    
+    // A streamed grain keeps the rest of its path requested (streams have no pyramid, so level 0)
+    if (source.isStreaming())
+    {
+        const double extent = (double)grain.samplesRemaining * increment;
+        source.prefetch((int)(grain.reverse ? position - extent : position), (int)extent + 1);
+    }
+    float phase = grain.envelope;
+    int offset = start;
+    int remaining = count;
+    
+    // Usually one span per block; another when the grain crosses the loop seam or,
+    // for streamed sources, a page edge (a resident source is a single page)
+    while (remaining > 0)
+    {
+        const int page = juce::jmin((int)position / pageLength, (sourceLength - 1) / pageLength);
+        const int pageStart = page * pageLength;
+        const double pagePosition = position - (double)pageStart;
+        const int pageSamples = juce::jmin(pageLength, sourceLength - pageStart);
         
-        // Apply voice envelope and velocity
-        const float envelopeValue = envelope.getNextSample();
-        outputL *= envelopeValue * velocity * 0.3f; // Scale down more for performance
-        outputR *= envelopeValue * velocity * 0.3f;
+        const int spanLength = juce::jmax(1, GrainKernels::spanLengthBeforeWrap(pagePosition, increment, grain.reverse, pageSamples, remaining));
+        const double lastPosition = grain.reverse ? pagePosition - (double)(spanLength - 1) * increment : pagePosition;
+        const int base = juce::jmax(0, (int)lastPosition);
         
-        // Apply filter
-        processFilter(outputL, outputR);
+        // A streamed page that isn't in yet plays as silence
+        if (const void* pageData = source.getPageReadPointer(level, page))
+        {
+            GrainSpan span;
+            span.source = static_cast<const char*>(pageData) + base * frameBytes;
+            span.position = (float)(pagePosition - (double)base);
+            span.increment = (float)increment;
+            span.window = window;
+            span.phase = phase;
+            span.phaseIncrement = grain.envelopeInc;
+            span.gainL = gainL;
+            span.gainR = gainR;
+            span.mixL = mixL + offset;
+            span.mixR = mixR + offset;
+            span.numSamples = spanLength;
+            span.sincTable = sincTable;
+            grain.kernel(span);
+        }
+        else
+        {
+            source.countMiss();
+        }
         
-        // Apply chorus for widening
-        processChorus(outputL, outputR);
+        const double distance = (double)spanLength * increment;
+        position = grain.reverse ? position - distance : position + distance;
+        phase += (float)spanLength * grain.envelopeInc;
+        offset += spanLength;
+        remaining -= spanLength;
         
-        // Add to output buffer
-        if (bufferIndex < buffer.getNumSamples())
+        // Handle looping/boundaries, keeping the fractional position across the seam
+        if (position >= (double)sourceLength || position < 0.0)
         {
-            buffer.addSample(0, bufferIndex, outputL);
-            if (buffer.getNumChannels() > 1)
-                buffer.addSample(1, bufferIndex, outputR);
+            position = std::fmod(position, (double)sourceLength);
+            if (position < 0.0)
+                position += (double)sourceLength;
+            if (position >= (double)sourceLength)
+                position = 0.0;
         }
     }
+    
+    grain.position = position * levelScale;
+    grain.envelope = phase;
+    grain.samplesRemaining -= count;
 }
 
-void GranularVoice::spawnGrain()
+void GranularVoice::spawnGrain(int startOffset)
 {
     if (!audioSource || audioSource->getNumSamples() == 0)
         return;
         
     Grain newGrain;
     
+    float draws[numGrainDraws];
+    random.fill(draws, numGrainDraws);
+    
     // CPU-Optimized LFO generation (use lookup tables or simple math)
     float lfoValue = generateLFO(0);  // LFO1
     float lfo2Value = generateLFO(1); // LFO2
@@ -221,51 +518,71 @@ void GranularVoice::spawnGrain()
     
     // Apply jitter to grain size for Ableton-style variation
     if (parameters.jitter > 0.01f) {
-        float jitterVariation = (random.nextFloat() * 2.0f - 1.0f) * parameters.jitter * 0.3f;
+        float jitterVariation = (draws[drawSize] * 2.0f - 1.0f) * parameters.jitter * 0.3f;
         grainSizeMs *= (1.0f + jitterVariation);
         grainSizeMs = juce::jlimit(10.0f, 2000.0f, grainSizeMs);
     }
     
-    newGrain.totalSamples = (int)(grainSizeMs * currentSampleRate / 1000.0f);
+    newGrain.totalSamples = juce::jmax(1, (int)(grainSizeMs * currentSampleRate / 1000.0f));
     newGrain.samplesRemaining = newGrain.totalSamples;
+    newGrain.envelopeInc = 1.0f / (float)newGrain.totalSamples;
+    newGrain.startOffset = startOffset;
+    newGrain.source = audioSource;
     
     // Set grain shape (CPU-optimized - store as integer)
-    newGrain.shapeType = (int)parameters.grainShape;
+    newGrain.shapeType = juce::jlimit(0, (int)GrainWindows::numShapes - 1, (int)parameters.grainShape);
+    
+    // Per-grain amplitude variation
+    if (parameters.grainAmp > 0.01f)
+        newGrain.ampMultiplier = 1.0f - draws[drawAmp] * parameters.grainAmp;
     
     // CPU-Optimized position calculation with Ableton-style features
-    float basePosition = calculateGrainPosition() * (audioSource->getNumSamples() - 1);
+    const double length = (double)audioSource->getNumSamples();
+    double basePosition = (double)calculateGrainPosition(startOffset) * (length - 1.0);
     if (parameters.lfoTarget == 0.0f && parameters.lfoAmount > 0.01f) // Position modulation
     {
-        basePosition += lfoValue * parameters.lfoAmount * audioSource->getNumSamples() * 0.3f;
+        basePosition += (double)(lfoValue * parameters.lfoAmount * 0.3f) * length;
     }
     
     // Apply scan motion (Ableton-style automatic movement)
     if (parameters.scan > 0.01f) {
-        basePosition += scanPhase * audioSource->getNumSamples();
+        basePosition += (double)scanPhase * length;
     }
     
     // Apply spray/texture (enhanced position randomization)
     float sprayAmount = juce::jmax(parameters.texture, parameters.spray);
     if (sprayAmount > 0.01f) {
-        float jitter = (random.nextFloat() * 2.0f - 1.0f) * sprayAmount * audioSource->getNumSamples() * 0.2f;
-        basePosition += jitter;
+        float jitter = (draws[drawSpray] * 2.0f - 1.0f) * sprayAmount * 0.2f;
+        basePosition += (double)jitter * length;
     }
     
     // Apply pitch jitter to individual grains
     if (parameters.pitchJitter > 0.01f) {
-        newGrain.pitchOffset = (random.nextFloat() * 2.0f - 1.0f) * parameters.pitchJitter * 12.0f; // ±12 semitones
+        newGrain.pitchOffset = (draws[drawPitch] * 2.0f - 1.0f) * parameters.pitchJitter * 12.0f; // ±12 semitones
     }
     
     // Apply loop mode boundaries (CPU-optimized)
     int loopMode = (int)parameters.loopMode;
     if (loopMode == 1) { // Backward
-        basePosition = audioSource->getNumSamples() - 1 - basePosition;
+        basePosition = length - 1.0 - basePosition;
     }
     // PingPong mode will be handled in grain position update
     
-    newGrain.startPosition = juce::jlimit(0.0f, (float)(audioSource->getNumSamples() - 1), basePosition);
+    newGrain.startPosition = juce::jlimit(0.0, length - 1.0, basePosition);
     newGrain.position = newGrain.startPosition;
     
+    // Starting a streamed grain on a missing page would fade it in mid-window later
+    if (!audioSource->isResident((int)newGrain.startPosition))
+    {
+        audioSource->countMiss();
+        return;
+    }
+    
+    // The engine budget bounds grains across all voices. Charged only once the grain
+    // is sure to start, since admitting may evict a sounding grain to make room.
+    if (!admitGrain())
+        return;
+    
     // CPU-Optimized pitch calculation with enhanced modulation
     float midiPitch = (midiNote - 60) / 12.0f;
     float totalPitch = parameters.pitch + parameters.grainPitch + midiPitch * 12.0f;
@@ -279,34 +596,55 @@ void GranularVoice::spawnGrain()
     // Add individual grain pitch jitter
     totalPitch += newGrain.pitchOffset;
     
-    newGrain.increment = std::pow(2.0f, totalPitch / 12.0f);
+    newGrain.increment = std::pow(2.0, (double)totalPitch / 12.0);
     
     // Account for source sample rate difference
     if (sourceSampleRate != currentSampleRate)
-        newGrain.increment *= (float)(sourceSampleRate / currentSampleRate);
+        newGrain.increment *= sourceSampleRate / currentSampleRate;
+    
+    // Octave-down copy that keeps the read step near one sample, so high pitches don't alias
+    newGrain.level = audioSource->getLevelForIncrement((float)newGrain.increment);
     
     // Reverse playback probability
-    newGrain.reverse = random.nextFloat() < parameters.reverse;
+    newGrain.reverse = draws[drawReverse] < parameters.reverse;
+    
+    // Shape, direction, channel count, interpolation and sample format are fixed for the grain's life, so pick its kernel now.
+    // A grain stepping exactly one frame (unpitched, source at the session rate) starts on a whole frame and
+    // reads frames directly; a sub-sample start offset is inaudible.
+    const auto interpolation = (GrainInterpolation)juce::jlimit(0, (int)grainInterpolationSinc, (int)parameters.quality);
+    auto chooseKernel = [&](Grain& grain) {
+        const bool unitStep = grain.increment == 1.0;
+        if (unitStep)
+            grain.position = std::floor(grain.position);
+        grain.kernel = GrainKernels::select(grain.shapeType, grain.reverse, audioSource->getNumChannels(),
+                                            unitStep ? grainInterpolationDirect : interpolation, audioSource->getSampleFormat());
+    };
+    chooseKernel(newGrain);
     
     // Calculate stereo positioning
-    float stereoPos = (random.nextFloat() * 2.0f - 1.0f) * parameters.stereoWidth;
+    float stereoPos = (draws[drawPan] * 2.0f - 1.0f) * parameters.stereoWidth;
     newGrain.panL = juce::jlimit(0.0f, 1.0f, 0.5f - stereoPos * 0.5f);
     newGrain.panR = juce::jlimit(0.0f, 1.0f, 0.5f + stereoPos * 0.5f);
     
     // Add the main grain
-    activeGrains.push_back(newGrain);
+    if (!activeGrains.add(newGrain))
+    {
+        releaseGrainSlot();
+        return;
+    }
+    ++numSpawned;
     
-    // Add unison grains for widening effect
+    // Add unison grains for widening effect, each admitted by the budget like any other
     int numUnisonVoices = (int)parameters.unisonVoices;
-    if (numUnisonVoices > 1 && activeGrains.size() < 12) // Limit total grains for performance
+    if (numUnisonVoices > 1)
     {
-        for (int i = 1; i < numUnisonVoices && activeGrains.size() < 16; ++i)
+        for (int i = 1; i < numUnisonVoices && admitGrain(); ++i)
         {
             Grain unisonGrain = newGrain; // Copy the main grain
             
             // Detune slightly for chorus effect
             float detuneAmount = ((float)i / (float)(numUnisonVoices - 1) - 0.5f) * 0.1f; // ±5 cents max
-            unisonGrain.increment *= std::pow(2.0f, detuneAmount / 12.0f);
+            unisonGrain.increment *= std::pow(2.0, (double)detuneAmount / 12.0);
             
             // Spread in stereo field
             float unisonStereoPos = ((float)i / (float)(numUnisonVoices - 1) - 0.5f) * parameters.stereoWidth;
@@ -314,36 +652,16 @@ void GranularVoice::spawnGrain()
             unisonGrain.panR = juce::jlimit(0.0f, 1.0f, 0.5f + unisonStereoPos * 0.5f);
             
             // Slightly different start position for texture
-            float positionVariation = (random.nextFloat() * 2.0f - 1.0f) * 0.01f; // ±1% position variation
-            unisonGrain.position = juce::jlimit(0.0f, (float)(audioSource->getNumSamples() - 1), 
-                                               newGrain.position + positionVariation * audioSource->getNumSamples());
+            float positionVariation = random.nextBipolar() * 0.01f; // ±1% position variation
+            unisonGrain.position = juce::jlimit(0.0, length - 1.0, newGrain.position + (double)positionVariation * length);
+            chooseKernel(unisonGrain);
             
-            activeGrains.push_back(unisonGrain);
+            if (activeGrains.add(unisonGrain))
+                ++numSpawned;
+            else
+                releaseGrainSlot();
         }
     }
-    
-    // Limit number of active grains for better CPU performance
-    if (activeGrains.size() > 20) // Further reduced from 32 to 20
-        activeGrains.erase(activeGrains.begin());
-}
-
-float GranularVoice::getInterpolatedSample(int channel, float position) const
-{
-    if (!audioSource || channel >= audioSource->getNumChannels() || audioSource->getNumSamples() == 0)
-        return 0.0f;
-        
-    // Linear interpolation
-    const int index0 = (int)position;
-    const int index1 = juce::jmin(index0 + 1, audioSource->getNumSamples() - 1);
-    const float fraction = position - index0;
-    
-    if (index0 < 0 || index0 >= audioSource->getNumSamples())
-        return 0.0f;
-        
-    const float sample0 = audioSource->getSample(channel, index0);
-    const float sample1 = audioSource->getSample(channel, index1);
-    
-    return juce::jmap(fraction, 0.0f, 1.0f, sample0, sample1);
 }
 
 // CPU-Optimized Enhanced LFO System
@@ -376,18 +694,15 @@ float GranularVoice::getLFOShape(float phase, int shapeType)
         case 1: return 2.0f * (phase / (2.0f * juce::MathConstants<float>::pi)) - 1.0f;  // Triangle (approximation)
         case 2: return (phase < juce::MathConstants<float>::pi) ? 1.0f : -1.0f;  // Square
         case 3: return 2.0f * (phase / (2.0f * juce::MathConstants<float>::pi)) - 1.0f;  // Saw
-        case 4: return (random.nextFloat() * 2.0f - 1.0f);  // Random
+        case 4: return random.nextBipolar();  // Random
         default: return std::sin(phase);
     }
 }
 
 void GranularVoice::processFilter(float& sampleL, float& sampleR)
 {
-    if (parameters.filterCutoff < 1.0f)
-    {
-        sampleL = filterL.processSample(sampleL);
-        sampleR = filterR.processSample(sampleR);
-    }
+    sampleL = filterL.processSample(sampleL);
+    sampleR = filterR.processSample(sampleR);
 }
 
 // CPU-Optimized Ableton-style scan position update
@@ -413,9 +728,10 @@ void GranularVoice::updateScanPosition()
 }
 
 // CPU-Optimized grain position calculation
-float GranularVoice::calculateGrainPosition()
+float GranularVoice::calculateGrainPosition(int offset)
 {
-    float position = parameters.position;
+    // Spawns outside a block (note on) take the ramp's current value
+    float position = blockPositions != nullptr ? blockPositions[offset] : positionRamp.getCurrentValue();
     
     // Apply freeze effect (Ableton-style)
     if (parameters.freeze > 0.01f) {
@@ -442,32 +758,10 @@ float GranularVoice::calculateGrainPitch(const Grain& grain)
     return pitch;
 }
 
-// CPU-Optimized grain envelope calculation
+// Grain envelope from the precomputed window tables
 float GranularVoice::calculateGrainEnvelope(const Grain& grain)
 {
-    float envelopePhase = 1.0f - (float)grain.samplesRemaining / (float)grain.totalSamples;
-    float grainEnvelope = 0.0f;
-    
-    // Apply grain shape (CPU-optimized)
-    switch (grain.shapeType) {
-        case 0: // Hann window (default)
-            grainEnvelope = 0.5f - 0.5f * std::cos(2.0f * juce::MathConstants<float>::pi * envelopePhase);
-            break;
-        case 1: // Triangle
-            grainEnvelope = (envelopePhase < 0.5f) ? (2.0f * envelopePhase) : (2.0f * (1.0f - envelopePhase));
-            break;
-        case 2: // Square (no envelope)
-            grainEnvelope = 1.0f;
-            break;
-        case 3: // Gaussian (approximation)
-            {
-                float x = (envelopePhase - 0.5f) * 4.0f; // Scale to -2 to 2
-                grainEnvelope = std::exp(-x * x);
-            }
-            break;
-        default:
-            grainEnvelope = 0.5f - 0.5f * std::cos(2.0f * juce::MathConstants<float>::pi * envelopePhase);
-    }
+    float grainEnvelope = windows != nullptr ? windows->getValue(grain.shapeType, grain.envelope) : 0.0f;
     
     // Apply grain amplitude variation
     if (parameters.grainAmp > 0.01f) {
@@ -489,7 +783,7 @@ bool GranularVoice::shouldSpawnGrain()
 
 float GranularVoice::calculateJitteredTiming()
 {
-    float jitterAmount = (random.nextFloat() * 2.0f - 1.0f) * parameters.jitter;
+    float jitterAmount = random.nextBipolar() * parameters.jitter;
     return 1.0f + jitterAmount * 0.5f; // ±50% timing variation
 }
 
@@ -1,10 +1,21 @@
 #pragma once
 #include <JuceHeader.h>
+#include "GrainPool.h"
+#include "GrainWindows.h"
+#include "GrainKernels.h"
+#include "GrainSource.h"
+#include "GrainBudget.h"
+#include "GrainRandom.h"
+#include "GranularSynthesiser.h"
+#include "ParameterRamp.h"
 
 // Professional Quanta-style granular synthesizer engine
 // Polyphonic with advanced grain processing and smooth interpolation
 class GranularVoice : public juce::SynthesiserVoice {
 public:
+    // Grains one voice can hold; the engine's GrainBudget decides how many actually sound
+    static constexpr int grainPoolCapacity = 64;
+    
     struct GranularParams {
         // Core granular parameters (Quanta-style)
         float grainSize = 100.0f;      // ms (10-2000)
@@ -19,7 +30,7 @@ public:
         float spray = 0.5f;            // 0-1 position randomization (enhanced texture)
         float jitter = 0.0f;           // 0-1 timing randomization
         float pitchJitter = 0.0f;      // 0-1 pitch randomization per grain
-        float grainShape = 0.0f;       // 0=Hann, 1=Triangle, 2=Square, 3=Gauss
+        float grainShape = 0.0f;       // 0=Hann, 1=Triangle, 2=Square, 3=Gauss, 4=Trapezoid, 5=Tukey
         float loopMode = 0.0f;         // 0=Forward, 1=Backward, 2=PingPong
         float glide = 0.0f;            // 0-1 portamento time
         
@@ -55,6 +66,14 @@ public:
         // Widening effects for constant granular sound
         float chorusAmount = 0.0f;     // 0-1 chorus effect amount
         float unisonVoices = 1.0f;     // 1-8 number of unison voices
+        
+        // Rendering
+        float quality = 1.0f;          // 0=Draft (linear), 1=Live (cubic), 2=Render (sinc)
+        float seed = 0.0f;             // 0 = fresh randomness per note, otherwise each key replays exactly
+        
+        // Every field is a float, so a byte compare is exact (no padding)
+        bool operator==(const GranularParams& other) const { return std::memcmp(this, &other, sizeof(GranularParams)) == 0; }
+        bool operator!=(const GranularParams& other) const { return !(*this == other); }
     };
     
     bool canPlaySound(juce::SynthesiserSound*) override { return true; }
@@ -65,20 +84,36 @@ public:
     void renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples) override;
     bool isVoiceActive() const override { return isActive; }
     
-    void setAudioSource(const juce::AudioBuffer<float>* source, double sourceSampleRate);
-    void setParameters(const GranularParams& params) { parameters = params; updateInternalParams(); }
+    void setAudioSource(const GrainSource* source);
+    void setGrainBudget(GrainBudget* budget) { grainBudget = budget; }
+    void setParameters(const GranularParams& newParams);
     void prepare(double sampleRate, int maximumBlockSize);
     float getCurrentLFOValue() const { return std::sin(lfoPhase); }
     
+    // Grain budget support, called by the engine between blocks
+    int getNumGrains() const { return activeGrains.size(); }
+    int takeNumSpawned() { const int spawned = numSpawned; numSpawned = 0; return spawned; } // Grains added since the last call
+    int getGrainAudibility(float* destination) const; // Writes one value per grain, returns the count
+    int cullGrains(float threshold, int& keepAtThreshold); // Removes quieter grains, returns how many
+    
+    // True while any grain still reads source (grains keep the source they were spawned from)
+    bool usesSource(const GrainSource* source) const;
+    
 private:
     struct Grain {
-        float position = 0.0f;         // Current position in source
-        float startPosition = 0.0f;    // Starting position
-        float increment = 1.0f;        // Playback speed
-        float envelope = 0.0f;         // Current envelope value
-        float envelopeInc = 0.0f;      // Envelope increment
+        // Double so positions keep their fraction far past 2^24 samples; kernels
+        // only see float offsets from the start of each span
+        double position = 0.0;         // Current position in source
+        double startPosition = 0.0;    // Starting position
+        double increment = 1.0;        // Playback speed
+        float envelope = 0.0f;         // Current window phase (0-1)
+        float envelopeInc = 0.0f;      // Window phase increment per sample
         int samplesRemaining = 0;      // Samples left in grain
         int totalSamples = 0;          // Total grain length
+        int startOffset = 0;           // Samples into the current block before the grain starts
+        GrainKernel kernel = nullptr;  // Render specialisation chosen at spawn time
+        int level = 0;                 // Source pyramid level chosen at spawn time
+        const GrainSource* source = nullptr; // Source at spawn time; reads stay on it through a swap
         float panL = 1.0f, panR = 1.0f; // Stereo positioning
         bool reverse = false;          // Reverse playbook
         float filterState1 = 0.0f, filterState2 = 0.0f; // Filter states
@@ -87,25 +122,32 @@ private:
         float pitchOffset = 0.0f;      // Individual grain pitch randomization
         float ampMultiplier = 1.0f;    // Per-grain amplitude variation
         float jitterOffset = 0.0f;     // Timing jitter for this grain
-        int shapeType = 0;             // Grain shape (0=Hann, 1=Triangle, 2=Square, 3=Gauss)
+        int shapeType = 0;             // Grain shape (GrainWindows::Shape)
         float formantShift = 1.0f;     // Formant preservation ratio
         float stereoPosition = 0.5f;   // Random stereo placement (0=left, 1=right)
     };
     
-    const juce::AudioBuffer<float>* audioSource = nullptr;
+    const GrainSource* audioSource = nullptr;
+    GrainBudget* grainBudget = nullptr;
     double sourceSampleRate = 44100.0;
     double currentSampleRate = 44100.0;
     
     GranularParams parameters;
-    std::vector<Grain> activeGrains;
+    
+    // Preallocated in prepare(); spawning and retiring grains never allocates
+    GrainPool<Grain> activeGrains;
     
     // Voice state
     bool isActive = false;
+    bool noteReleased = false;
+    float envelopeLevel = 0.0f;    // Voice envelope at the end of the last block
     float velocity = 1.0f;
     int midiNote = 60;
     float pitchBend = 0.0f;
     
     // Grain spawning
+    int numSpawned = 0;
+    int numInitialGrains = 0;      // Spawned at the start of the first render after startNote
     float grainSpawnTimer = 0.0f;
     float grainSpawnInterval = 0.1f;
     
@@ -122,6 +164,11 @@ private:
     juce::dsp::IIR::Filter<float> hpFilterL, hpFilterR;  // High-pass filters
     juce::dsp::IIR::Filter<float> bpFilterL, bpFilterR;  // Band-pass filters
     
+    // Smoothed automation: position is read per spawn offset, cutoff every few samples
+    static constexpr int filterUpdateInterval = 32;
+    ParameterRamp positionRamp, cutoffRamp;
+    const float* blockPositions = nullptr; // Position ramp for the block being scheduled
+    
     // Scan and Motion System
     float scanPhase = 0.0f;        // Current scan position
     float scanDirection = 1.0f;    // Scan direction (1 = forward, -1 = backward)
@@ -134,18 +181,37 @@ private:
     float jitterAccumulator = 0.0f;
     float nextGrainTime = 0.0f;
     
-    // Random number generation
-    juce::Random random;
+    // Random number generation: one stream per note, keyed by the seed (see startNote)
+    GrainRandom random;
+    juce::uint32 freeRunningKey = 0;
+    
+    // Per-grain random draws, taken in one fill() so every grain consumes the same
+    // count and enabling one feature doesn't reshuffle the others
+    enum GrainDraw { drawSize, drawAmp, drawSpray, drawPitch, drawReverse, drawPan, numGrainDraws };
     
     // Chorus effect for widening
     juce::dsp::DelayLine<float> chorusDelayL { 48000 };
     juce::dsp::DelayLine<float> chorusDelayR { 48000 };
     float chorusLFOPhase = 0.0f;
     
+    // Block-oriented rendering: grains accumulate into this stereo scratch buffer
+    juce::AudioBuffer<float> grainMixBuffer;
+    
+    // Shared window lookup tables (built in prepare)
+    const GrainWindows* windows = nullptr;
+    
     void updateInternalParams();
-    void spawnGrain();
+    void updateEnvelopeParams();
+    void spawnGrain(int startOffset = 0);
     void updateGrains(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
-    float getInterpolatedSample(int channel, float position) const;
+    void scheduleGrainSpawns(int numSamples);
+    void renderGrain(Grain& grain, float* mixL, float* mixR, int numSamples);
+    bool admitGrain();
+    void releaseGrainSlot();
+    void prefetchSpawnWindow();
+    float getVoiceAudibility() const;
+    float getGrainAudibility(const Grain& grain, float voiceAudibility) const;
+    int findLeastAudibleGrain() const;
     
     // Enhanced LFO System
     float generateLFO(int lfoIndex = 0);  // 0=LFO1, 1=LFO2
@@ -153,14 +219,14 @@ private:
     
     // Advanced Granular Features
     void updateScanPosition();
-    float calculateGrainPosition();  // Position with scan, spray, and jitter
+    float calculateGrainPosition(int offset);  // Position with scan, spray, and jitter
     float calculateGrainPitch(const Grain& grain);
     float calculateGrainEnvelope(const Grain& grain);
     void applyGrainShape(Grain& grain, float& envelope);
     
     // Enhanced Filter System
     void processFilter(float& sampleL, float& sampleR);
-    void updateFilterCoefficients();
+    void updateFilterCoefficients(float cutoff);
     void processFormantShift(float& sampleL, float& sampleR, float shiftAmount);
     
     // Timing and Jitter
@@ -182,46 +248,115 @@ public:
 class GranularEngine {
 public:
     using Params = GranularVoice::GranularParams;
+    
+    // What the last render did, for telemetry
+    struct BlockStats {
+        int activeVoices = 0;
+        int activeGrains = 0;   // Sounding at the end of the block
+        int grainsSpawned = 0;
+        int grainsCulled = 0;   // By the budget or a full pool, including refused spawns
+    };
+    
+    static constexpr int defaultNumVoices = 8;
 
-    void prepare(double sampleRate, int maximumBlockSize) {
+    void prepare(double sampleRate, int maximumBlockSize, int numVoices = defaultNumVoices) {
         synthesizer.setCurrentPlaybackSampleRate(sampleRate);
         
-        // Clear existing voices and sounds
+        // Clear existing voices and sounds (the new voices hold no grains from an old source)
         synthesizer.clearVoices();
         synthesizer.clearSounds();
+        previousSource = nullptr;
         
-        // Add polyphonic voices (reduced to 8 for better performance)
-        for (int i = 0; i < 8; ++i) {
+        // Add polyphonic voices (8 by default for better performance)
+        // New voices start from the current snapshot and source; setParams only pushes changes
+        granularVoices.clear();
+        for (int i = 0; i < numVoices; ++i) {
             auto voice = new GranularVoice();
+            voice->setParameters(currentParams);
+            voice->setAudioSource(audioSource);
+            voice->setGrainBudget(&grainBudget);
             voice->prepare(sampleRate, maximumBlockSize);
             synthesizer.addVoice(voice);
+            granularVoices.push_back(voice);
         }
         
         // Add sound
         synthesizer.addSound(new GranularSound());
+        
+        // Per-voice scratch and worker threads for the optional multi-core mode
+        synthesizer.prepareParallelRendering(maximumBlockSize);
+        
+        grainAudibility.resize(granularVoices.size() * (size_t)GranularVoice::grainPoolCapacity);
+    }
+    
+    // Most grains sounding at once across all voices; 0 for no limit
+    void setGrainBudget(int maxGrains) {
+        grainBudget.setLimit(maxGrains);
+    }
+    
+    // Grains culled or refused by the budget since construction (any thread)
+    juce::int64 getNumCulledGrains() const { return grainBudget.getNumCulled(); }
+    
+    // Render active voices on worker threads (opt-in). The workers start and stop on the
+    // message thread; without a message loop, set this before prepare().
+    void setParallelRendering(bool shouldRenderInParallel) {
+        synthesizer.setParallelRendering(shouldRenderInParallel);
     }
     
     void reset() {
         synthesizer.allNotesOff(0, true);
     }
     
-    void setSource(const juce::AudioBuffer<float>* source, double sourceRate) {
-        for (int i = 0; i < synthesizer.getNumVoices(); ++i) {
-            if (auto* granularVoice = dynamic_cast<GranularVoice*>(synthesizer.getVoice(i))) {
-                granularVoice->setAudioSource(source, sourceRate);
-            }
-        }
-        audioSource = source;
-        sourceSampleRate = sourceRate;
+    // Audio thread, at the start of each block. New grains come from latest while
+    // grains already sounding finish on the old source, so a swap crossfades over
+    // one grain length. A further swap waits until the old source is unused.
+    void updateSource(const GrainSource* latest) {
+        if (previousSource != nullptr && !anyVoiceUses(previousSource))
+            previousSource = nullptr;
+            
+        if (latest == audioSource || previousSource != nullptr)
+            return;
+            
+        previousSource = audioSource;
+        for (auto* voice : granularVoices)
+            voice->setAudioSource(latest);
+        audioSource = latest;
+        sourceSampleRate = latest != nullptr ? latest->getSampleRate() : 44100.0;
     }
     
+    // The oldest source any grain may still read, or nullptr
+    const GrainSource* getOldestSourceInUse() const {
+        return previousSource != nullptr ? previousSource : audioSource;
+    }
+    
+    // Publishes a new snapshot to the voices only when a value changed
     void setParams(const Params& p) {
+        if (p == currentParams)
+            return;
+            
         currentParams = p;
-        for (int i = 0; i < synthesizer.getNumVoices(); ++i) {
-            if (auto* granularVoice = dynamic_cast<GranularVoice*>(synthesizer.getVoice(i))) {
-                granularVoice->setParameters(p);
-            }
-        }
+        ++paramsVersion;
+        for (auto* voice : granularVoices)
+            voice->setParameters(currentParams);
+    }
+    
+    // Bumped on every published change
+    juce::uint32 getParamsVersion() const { return paramsVersion; }
+    
+    // Grains sounding across all voices, as of the last block
+    int getNumActiveGrains() const {
+        int sounding = 0;
+        for (const auto* voice : granularVoices)
+            sounding += voice->getNumGrains();
+        return sounding;
+    }
+    
+    // False once every voice has finished its release and grains
+    bool hasActiveVoices() const {
+        for (const auto* voice : granularVoices)
+            if (voice->isVoiceActive())
+                return true;
+        return false;
     }
     
     void noteOn(int midiNote, float velocity) {
@@ -237,8 +372,31 @@ public:
     }
     
     void render(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) {
+        const auto culledBefore = grainBudget.getNumCulled();
+        enforceGrainBudget();
+        
+        // Streamed sources recycle pages only outside this window
+        if (audioSource != nullptr) audioSource->beginBlock();
+        if (previousSource != nullptr) previousSource->beginBlock();
+        
         synthesizer.renderNextBlock(buffer, midiMessages, 0, buffer.getNumSamples());
+        
+        if (previousSource != nullptr) previousSource->endBlock();
+        if (audioSource != nullptr) audioSource->endBlock();
+        
+        // Voices rendered on workers have finished by now
+        blockStats = {};
+        for (auto* voice : granularVoices)
+        {
+            blockStats.activeVoices += voice->isVoiceActive() ? 1 : 0;
+            blockStats.activeGrains += voice->getNumGrains();
+            blockStats.grainsSpawned += voice->takeNumSpawned();
+        }
+        blockStats.grainsCulled = (int)(grainBudget.getNumCulled() - culledBefore);
     }
+    
+    // Audio thread, after render()
+    const BlockStats& getLastBlockStats() const { return blockStats; }
 
     // UI feedback
     float getPlayheadNorm() const {
@@ -271,8 +429,50 @@ public:
     }
 
 private:
-    juce::Synthesiser synthesizer;
-    const juce::AudioBuffer<float>* audioSource = nullptr;
+    // Culls the least audible grains across all voices down to the budget, then
+    // leaves the remaining headroom for this block's spawns
+    void enforceGrainBudget() {
+        int sounding = getNumActiveGrains();
+        
+        const int limit = grainBudget.getLimit();
+        if (grainBudget.isLimited() && sounding > limit)
+        {
+            int numValues = 0;
+            for (auto* voice : granularVoices)
+                numValues += voice->getGrainAudibility(grainAudibility.data() + numValues);
+                
+            // The limit-th most audible grain sets the bar; ties are kept until the limit is met
+            const auto first = grainAudibility.begin();
+            std::nth_element(first, first + (limit - 1), first + numValues, std::greater<float>());
+            const float threshold = grainAudibility[(size_t)(limit - 1)];
+            int keepAtThreshold = limit - (int)std::count_if(first, first + limit, [threshold](float a) { return a > threshold; });
+            
+            int removed = 0;
+            for (auto* voice : granularVoices)
+                removed += voice->cullGrains(threshold, keepAtThreshold);
+                
+            grainBudget.addCulled(removed);
+            sounding -= removed;
+        }
+        
+        grainBudget.beginBlock(sounding);
+    }
+    
+    bool anyVoiceUses(const GrainSource* source) const {
+        for (const auto* voice : granularVoices)
+            if (voice->usesSource(source))
+                return true;
+        return false;
+    }
+    
+    GrainBudget grainBudget; // Declared before the synthesizer, whose voices point at it
+    GranularSynthesiser synthesizer;
+    std::vector<GranularVoice*> granularVoices; // Owned by synthesizer; cached to avoid dynamic_cast per block
+    const GrainSource* audioSource = nullptr;
+    const GrainSource* previousSource = nullptr; // Still read by fading grains after a swap
     double sourceSampleRate = 44100.0;
     Params currentParams;
+    juce::uint32 paramsVersion = 0;
+    BlockStats blockStats;
+    std::vector<float> grainAudibility; // Scratch for enforceGrainBudget, sized in prepare
 };
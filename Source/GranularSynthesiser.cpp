@@ -0,0 +1,200 @@
+#include "GranularSynthesiser.h"
+
+class GranularSynthesiser::Worker : public juce::Thread {
+public:
+    explicit Worker(GranularSynthesiser& s) : juce::Thread("Granular voice worker"), owner(s) {}
+    
+    ~Worker() override {
+        stop();
+    }
+    
+    void stop() {
+        signalThreadShouldExit();
+        wake.signal();
+        stopThread(1000);
+    }
+    
+    // Signalling the event takes a lock, so only a worker that has gone to sleep gets
+    // it; a spinning one sees the new generation on its own
+    void wakeUp() {
+        if (sleeping.load(std::memory_order_seq_cst))
+            wake.signal();
+    }
+    
+    void run() override {
+        auto seen = owner.getGeneration();
+        
+        while (!threadShouldExit())
+        {
+            // Spin for a short while: the next block usually follows quickly
+            int spins = 0;
+            while (owner.getGeneration() == seen && !threadShouldExit())
+            {
+                if (++spins > spinLimit)
+                {
+                    // Announce the sleep, then recheck: with both sides sequentially consistent,
+                    // either wakeUp() sees the flag or this sees the new generation
+                    sleeping.store(true, std::memory_order_seq_cst);
+                    if (owner.getGeneration() == seen && !threadShouldExit())
+                        wake.wait(100);
+                    sleeping.store(false, std::memory_order_relaxed);
+                    spins = 0;
+                }
+            }
+            
+            seen = owner.getGeneration();
+            owner.runJobs();
+        }
+    }
+
+private:
+    static constexpr int spinLimit = 4000;
+    
+    GranularSynthesiser& owner;
+    juce::WaitableEvent wake;
+    std::atomic<bool> sleeping { false };
+};
+
+GranularSynthesiser::GranularSynthesiser() = default;
+
+GranularSynthesiser::~GranularSynthesiser()
+{
+    cancelPendingUpdate();
+    stopWorkers();
+}
+
+void GranularSynthesiser::setParallelRendering(bool shouldRenderInParallel)
+{
+    // Starting and stopping threads isn't real-time safe, so it happens on the message thread
+    if (parallelEnabled.exchange(shouldRenderInParallel, std::memory_order_relaxed) != shouldRenderInParallel)
+        triggerAsyncUpdate();
+}
+
+void GranularSynthesiser::prepareParallelRendering(int maximumBlockSize)
+{
+    stopWorkers();
+    
+    voiceBuffers.resize((size_t)getNumVoices());
+    for (auto& buffer : voiceBuffers)
+        buffer.setSize(scratchChannels, juce::jmax(1, maximumBlockSize));
+    jobVoices.assign((size_t)getNumVoices(), 0);
+    
+    // Leave a core for the host; the audio thread renders alongside the workers
+    const int numWorkers = juce::jlimit(0, 3, juce::SystemStats::getNumCpus() - 2);
+    for (int i = 0; i < numWorkers; ++i)
+        workers.push_back(std::make_unique<Worker>(*this));
+        
+    updateWorkers();
+}
+
+void GranularSynthesiser::updateWorkers()
+{
+    const juce::ScopedLock sl (workerLock);
+    const bool wanted = parallelEnabled.load(std::memory_order_relaxed) && !workers.empty();
+    if (wanted == workersRunning.load(std::memory_order_relaxed))
+        return;
+        
+    if (wanted)
+    {
+        for (auto& worker : workers)
+            worker->startThread(juce::Thread::Priority::highest);
+        workersRunning.store(true, std::memory_order_release);
+    }
+    else
+    {
+        // A block already sharing out jobs still finishes: the audio thread takes
+        // whatever a stopping worker hasn't claimed
+        workersRunning.store(false, std::memory_order_release);
+        for (auto& worker : workers)
+            worker->stop();
+    }
+}
+
+void GranularSynthesiser::handleAsyncUpdate()
+{
+    updateWorkers();
+}
+
+void GranularSynthesiser::stopWorkers()
+{
+    const juce::ScopedLock sl (workerLock);
+    workersRunning.store(false, std::memory_order_release);
+    workers.clear();
+}
+
+void GranularSynthesiser::renderVoices(juce::AudioBuffer<float>& outputAudio, int startSample, int numSamples)
+{
+    const bool scratchFits = (int)voiceBuffers.size() == getNumVoices()
+                          && !voiceBuffers.empty()
+                          && startSample + numSamples <= voiceBuffers.front().getNumSamples();
+    
+    if (!parallelEnabled.load(std::memory_order_relaxed) || !workersRunning.load(std::memory_order_acquire) || !scratchFits)
+    {
+        juce::Synthesiser::renderVoices(outputAudio, startSample, numSamples);
+        return;
+    }
+    
+    int numJobs = 0;
+    for (int i = 0; i < getNumVoices(); ++i)
+        if (voices[i]->isVoiceActive())
+            jobVoices[(size_t)numJobs++] = i;
+    
+    // Nothing to share out
+    if (numJobs < 2)
+    {
+        for (int j = 0; j < numJobs; ++j)
+            voices[jobVoices[(size_t)j]]->renderNextBlock(outputAudio, startSample, numSamples);
+        return;
+    }
+    
+    jobStartSample = startSample;
+    jobNumSamples = numSamples;
+    jobsDone.store(0, std::memory_order_relaxed);
+    
+    // Publishes the job fields above; sequentially consistent against the workers' sleep flags
+    const auto nextGeneration = (juce::uint64)(getGeneration() + 1);
+    work.store((nextGeneration << 32) | ((juce::uint64)numJobs << 16), std::memory_order_seq_cst);
+    
+    for (auto& worker : workers)
+        worker->wakeUp();
+    
+    runJobs();
+    
+    while (jobsDone.load(std::memory_order_acquire) < numJobs)
+    {
+        // Workers are finishing their last voice
+    }
+    
+    // Sum in voice order, exactly as serial rendering accumulates
+    const int numChannels = juce::jmin(outputAudio.getNumChannels(), scratchChannels);
+    for (int j = 0; j < numJobs; ++j)
+    {
+        const auto& buffer = voiceBuffers[(size_t)jobVoices[(size_t)j]];
+        for (int ch = 0; ch < numChannels; ++ch)
+            outputAudio.addFrom(ch, startSample, buffer, ch, startSample, numSamples);
+    }
+}
+
+void GranularSynthesiser::runJobs()
+{
+    auto state = work.load(std::memory_order_acquire);
+    
+    for (;;)
+    {
+        const int numJobs = (int)((state >> 16) & 0xffff);
+        const int job = (int)(state & 0xffff);
+        if (job >= numJobs)
+            return;
+        
+        if (!work.compare_exchange_weak(state, state + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+            continue;
+        
+        const int voiceIndex = jobVoices[(size_t)job];
+        auto& buffer = voiceBuffers[(size_t)voiceIndex];
+        buffer.clear(jobStartSample, jobNumSamples);
+        voices[voiceIndex]->renderNextBlock(buffer, jobStartSample, jobNumSamples);
+        
+        jobsDone.fetch_add(1, std::memory_order_release);
+        state = work.load(std::memory_order_acquire);
+    }
+}
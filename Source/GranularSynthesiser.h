@@ -0,0 +1,63 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Synthesiser that can render its active voices on several cores
+// In parallel mode each active voice renders into its own scratch buffer on a
+// small pool of worker threads (the audio thread takes jobs too), then the
+// scratch buffers are summed into the output in voice order, so the result
+// matches serial rendering exactly. The workers run only while the mode is on;
+// they are started and stopped on the message thread. Between blocks they spin
+// briefly, then sleep on an event. The audio thread signals the event (which
+// takes a lock) only for a worker that has announced it is sleeping; a spinning
+// worker picks up the new generation itself. Nothing is allocated after prepare.
+class GranularSynthesiser : public juce::Synthesiser,
+                            private juce::AsyncUpdater {
+public:
+    GranularSynthesiser();
+    ~GranularSynthesiser() override;
+    
+    // Not real-time safe: sizes the per-voice scratch buffers and creates the workers,
+    // starting them if the mode is on. Call after the voices have been added.
+    void prepareParallelRendering(int maximumBlockSize);
+    
+    // Any thread, the audio thread included. A change starts or stops the workers
+    // asynchronously on the message thread; until then rendering stays serial.
+    // Without a message loop (command-line tools), set it before prepareParallelRendering.
+    void setParallelRendering(bool shouldRenderInParallel);
+    bool isParallelRenderingEnabled() const { return parallelEnabled.load(std::memory_order_relaxed); }
+
+protected:
+    void renderVoices(juce::AudioBuffer<float>& outputAudio, int startSample, int numSamples) override;
+
+private:
+    class Worker;
+    friend class Worker;
+    
+    // Claims and renders jobs until none are left; called by the workers and the audio thread
+    void runJobs();
+    void updateWorkers(); // Starts or stops the workers to match the mode
+    void stopWorkers();
+    void handleAsyncUpdate() override;
+    juce::uint32 getGeneration() const { return (juce::uint32)(work.load(std::memory_order_seq_cst) >> 32); }
+    
+    static constexpr int scratchChannels = 2; // Voices write at most stereo
+    
+    std::vector<std::unique_ptr<Worker>> workers;       // Created in prepare, running only while the mode is on
+    std::atomic<bool> workersRunning { false };
+    juce::CriticalSection workerLock;                   // Guards starting and stopping; never taken by the audio thread
+    std::vector<juce::AudioBuffer<float>> voiceBuffers; // One per voice, indexed like voices
+    std::vector<int> jobVoices;                         // Active voice indices for the current call
+    std::atomic<bool> parallelEnabled { false };
+    
+    // Current call; written by the audio thread before it publishes work
+    int jobStartSample = 0;
+    int jobNumSamples = 0;
+    
+    // Generation (bits 32-63) | number of jobs (16-31) | next unclaimed job (0-15).
+    // Claiming by compare-and-swap on the whole word means a worker that wakes
+    // late can never take a job from a newer call with an older index.
+    std::atomic<juce::uint64> work { 0 };
+    std::atomic<int> jobsDone { 0 };
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GranularSynthesiser)
+};
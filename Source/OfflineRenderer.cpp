@@ -0,0 +1,268 @@
+#include "OfflineRenderer.h"
+#include "GrainResampler.h"
+
+namespace {
+    // Header of the blob AudioProcessor::copyXmlToBinary writes
+    constexpr juce::uint32 stateBlobMagic = 0x21324356;
+}
+
+OfflineRenderer::OfflineRenderer(const Settings& renderSettings)
+    : settings(renderSettings)
+{
+    formats.registerBasicFormats();
+    settings.blockSize = juce::jmax(1, settings.blockSize);
+}
+
+juce::Result OfflineRenderer::loadSample(const juce::File& file)
+{
+    std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor(file));
+    if (reader == nullptr)
+        return juce::Result::fail("Can't read " + file.getFullPathName());
+    
+    if (reader->lengthInSamples <= 0 || reader->lengthInSamples > std::numeric_limits<int>::max())
+        return juce::Result::fail(file.getFileName() + " is empty or too long");
+    
+    juce::AudioBuffer<float> decoded ((int)juce::jmax(1u, reader->numChannels), (int)reader->lengthInSamples);
+    reader->read(&decoded, 0, (int)reader->lengthInSamples, 0, true, true);
+    
+    loadSample(decoded, reader->sampleRate);
+    return juce::Result::ok();
+}
+
+void OfflineRenderer::loadSample(const juce::AudioBuffer<float>& audio, double sampleRate)
+{
+    if (sampleRate > 0.0 && sampleRate != settings.sampleRate)
+        source = new GrainSource(GrainResampler::convert(audio, sampleRate, settings.sampleRate, [] { return false; }),
+                                 settings.sampleRate, 1, settings.sampleFormat);
+    else
+        source = new GrainSource(audio, settings.sampleRate, 1, settings.sampleFormat);
+        
+    source->buildPyramid(settings.pyramidBudgetBytes, [] { return false; });
+}
+
+juce::Result OfflineRenderer::loadState(const juce::File& file)
+{
+    juce::MemoryBlock data;
+    if (!file.loadFileAsData(data))
+        return juce::Result::fail("Can't read " + file.getFullPathName());
+    
+    // Either the plugin's binary state or its XML as text
+    juce::String text;
+    const auto* bytes = static_cast<const char*>(data.getData());
+    if (data.getSize() > 8 && juce::ByteOrder::littleEndianInt(bytes) == stateBlobMagic)
+    {
+        const auto length = (size_t)juce::ByteOrder::littleEndianInt(bytes + 4);
+        text = juce::String::fromUTF8(bytes + 8, (int)juce::jmin(length, data.getSize() - 8));
+    }
+    else
+    {
+        text = data.toString();
+    }
+    
+    std::unique_ptr<juce::XmlElement> state (juce::parseXML(text));
+    if (state == nullptr)
+        return juce::Result::fail(file.getFileName() + " is not a saved plugin state");
+    
+    return applyState(*state);
+}
+
+juce::Result OfflineRenderer::applyState(const juce::XmlElement& state)
+{
+    // The parameter tree writes one <PARAM id="..." value="..."/> per parameter
+    auto findValue = [&state](const char* id, float& value) {
+        for (auto* param : state.getChildWithTagNameIterator("PARAM"))
+        {
+            if (param->getStringAttribute("id") == id)
+            {
+                value = (float)param->getDoubleAttribute("value", (double)value);
+                return true;
+            }
+        }
+        return false;
+    };
+    
+    // States saved before a parameter existed leave it out; the plugin loads them with its default
+    juce::StringArray missing;
+    for (const auto& [id, field, defaultValue] : engineParameterFields)
+    {
+        params.*field = defaultValue;
+        if (!findValue(id, params.*field))
+            missing.add(id);
+    }
+    
+    stateWarnings.clear();
+    if (missing.size() > 0)
+        stateWarnings.add("State has no " + missing.joinIntoString(", ") + "; using the default");
+    
+    findValue(Params::Quality, params.quality);
+    findValue(Params::Level, level);
+    findValue(Params::DelayMix, delayMix);
+    findValue(Params::ReverbMix, reverbMix);
+    
+    float budgetIndex = 3.0f;
+    findValue(Params::GrainBudget, budgetIndex);
+    grainBudget = grainBudgetSizes[(size_t)juce::jlimit(0, (int)grainBudgetSizes.size() - 1, (int)budgetIndex)];
+    
+    stateSamplePath = state.getStringAttribute("samplePath");
+    return juce::Result::ok();
+}
+
+double OfflineRenderer::getTailSeconds() const
+{
+    if (settings.tailSeconds >= 0.0)
+        return settings.tailSeconds;
+    
+    // Like the plugin's tail: the voice release, then the effects ringing out
+    return params.release / 1000.0 + effects.getTailSeconds(delayMix, reverbMix);
+}
+
+OfflineRenderer::Timing OfflineRenderer::render(const juce::MidiMessageSequence& events, juce::AudioBuffer<float>& output)
+{
+    const double sampleRate = settings.sampleRate;
+    const int blockSize = settings.blockSize;
+    
+    // The plugin renders non-realtime bounces with sinc, whatever the state's quality says
+    auto renderParams = params;
+    if (settings.quality >= 0)
+        renderParams.quality = (float)juce::jlimit(0, 2, settings.quality);
+    if (settings.seed > 0)
+        renderParams.seed = (float)settings.seed;
+    
+    // No message loop here, so the workers have to start with prepare()
+    engine.setParallelRendering(settings.parallel);
+    engine.prepare(sampleRate, blockSize);
+    engine.setParams(renderParams);
+    engine.setGrainBudget(grainBudget);
+    effects.prepare(sampleRate, blockSize, level);
+    
+    double lastEventSeconds = 0.0;
+    for (int i = 0; i < events.getNumEvents(); ++i)
+        lastEventSeconds = juce::jmax(lastEventSeconds, events.getEventPointer(i)->message.getTimeStamp());
+    
+    const int totalSamples = juce::jmax(1, (int)std::ceil((lastEventSeconds + getTailSeconds()) * sampleRate));
+    output.setSize(2, totalSamples);
+    output.clear();
+    
+    Timing timing;
+    timing.blockSize = blockSize;
+    timing.audioSeconds = (double)totalSamples / sampleRate;
+    timing.blockSeconds.reserve((size_t)(totalSamples / blockSize + 1));
+    
+    juce::AudioBuffer<float> block (2, blockSize);
+    juce::MidiBuffer midi;
+    int nextEvent = 0;
+    
+    for (int start = 0; start < totalSamples; start += blockSize)
+    {
+        const int numSamples = juce::jmin(blockSize, totalSamples - start);
+        
+        // This block's events, at their sample offsets
+        midi.clear();
+        for (; nextEvent < events.getNumEvents(); ++nextEvent)
+        {
+            const auto& message = events.getEventPointer(nextEvent)->message;
+            const int position = (int)std::round(message.getTimeStamp() * sampleRate);
+            if (position >= start + numSamples)
+                break;
+            if (!message.isMetaEvent())
+                midi.addEvent(message, juce::jmax(0, position - start));
+        }
+        
+        block.setSize(2, numSamples, false, false, true);
+        block.clear();
+        
+        // Timed like processBlock: engine and effects
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        engine.updateSource(source.get());
+        engine.render(block, midi);
+        effects.process(block, level, delayMix, reverbMix);
+        timing.blockSeconds.push_back(juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks));
+        
+        for (int ch = 0; ch < 2; ++ch)
+            output.copyFrom(ch, start, block, ch, 0, numSamples);
+    }
+    
+    for (double seconds : timing.blockSeconds)
+        timing.renderSeconds += seconds;
+    
+    return timing;
+}
+
+double OfflineRenderer::Timing::getMaxBlockSeconds() const
+{
+    return blockSeconds.empty() ? 0.0 : *std::max_element(blockSeconds.begin(), blockSeconds.end());
+}
+
+double OfflineRenderer::Timing::getMeanBlockSeconds() const
+{
+    return blockSeconds.empty() ? 0.0 : renderSeconds / (double)blockSeconds.size();
+}
+
+double OfflineRenderer::Timing::getBlockPercentile(double percentile) const
+{
+    if (blockSeconds.empty())
+        return 0.0;
+    
+    // Nearest rank
+    auto sorted = blockSeconds;
+    std::sort(sorted.begin(), sorted.end());
+    const auto rank = (size_t)std::ceil(percentile / 100.0 * (double)sorted.size());
+    return sorted[juce::jlimit((size_t)0, sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+juce::Result OfflineRenderer::readMidiFile(const juce::File& file, juce::MidiMessageSequence& events)
+{
+    juce::FileInputStream stream (file);
+    juce::MidiFile midiFile;
+    if (!stream.openedOk() || !midiFile.readFrom(stream))
+        return juce::Result::fail("Can't read MIDI from " + file.getFullPathName());
+    
+    // Every track on one timeline, in seconds
+    midiFile.convertTimestampTicksToSeconds();
+    events.clear();
+    for (int track = 0; track < midiFile.getNumTracks(); ++track)
+        events.addSequence(*midiFile.getTrack(track), 0.0);
+    events.sort();
+    events.updateMatchedPairs();
+    return juce::Result::ok();
+}
+
+juce::Result OfflineRenderer::readWavFile(const juce::File& file, juce::AudioBuffer<float>& audio)
+{
+    // The reader dereferences its stream, so a missing file has to be caught here
+    if (!file.existsAsFile())
+        return juce::Result::fail("No such file: " + file.getFullPathName());
+    
+    auto stream = file.createInputStream();
+    if (stream == nullptr)
+        return juce::Result::fail("Can't open " + file.getFullPathName());
+    
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::AudioFormatReader> reader (wav.createReaderFor(stream.release(), true));
+    if (reader == nullptr)
+        return juce::Result::fail("Can't read " + file.getFullPathName());
+    
+    audio.setSize((int)reader->numChannels, (int)reader->lengthInSamples);
+    reader->read(&audio, 0, audio.getNumSamples(), 0, true, true);
+    return juce::Result::ok();
+}
+
+juce::Result OfflineRenderer::writeWavFile(const juce::File& file, const juce::AudioBuffer<float>& audio, double sampleRate, int bitsPerSample)
+{
+    file.deleteFile();
+    auto stream = std::make_unique<juce::FileOutputStream>(file);
+    if (!stream->openedOk())
+        return juce::Result::fail("Can't write " + file.getFullPathName());
+    
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::AudioFormatWriter> writer (wav.createWriterFor(stream.get(), sampleRate, (unsigned int)audio.getNumChannels(),
+                                                                          bitsPerSample, {}, 0));
+    if (writer == nullptr)
+        return juce::Result::fail("Can't write " + juce::String(bitsPerSample) + "-bit WAV");
+    
+    // The writer owns the stream now
+    stream.release();
+    if (!writer->writeFromAudioSampleBuffer(audio, 0, audio.getNumSamples()))
+        return juce::Result::fail("Writing " + file.getFullPathName() + " failed");
+    return juce::Result::ok();
+}
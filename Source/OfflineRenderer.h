@@ -0,0 +1,83 @@
+#pragma once
+#include <JuceHeader.h>
+#include "GranularEngine.h"
+#include "EffectsChain.h"
+#include "EngineParameters.h"
+
+// Runs the engine and effects without a host or plugin wrapper
+// Loads a sample the way the plugin does (decoded, converted to the render
+// rate, with its pyramid complete before rendering starts so runs repeat
+// exactly), applies a state saved by the plugin, and renders a MIDI sequence
+// block by block, timing each block. Needs no GUI modules.
+class OfflineRenderer {
+public:
+    struct Settings {
+        double sampleRate = 48000.0;
+        int blockSize = 512;
+        int seed = 1;                   // Engine seed (0 keeps the state's, which may be unseeded)
+        int quality = 2;                // Interpolation; Render (2) like a host bounce, -1 keeps the state's
+        bool parallel = false;          // Render voices on worker threads
+        GrainSampleFormat sampleFormat = grainSampleFloat32;
+        size_t pyramidBudgetBytes = (size_t)128 * 1024 * 1024;
+        double tailSeconds = -1.0;      // After the last MIDI event; negative for the release plus effects tail
+    };
+    
+    struct Timing {
+        std::vector<double> blockSeconds;
+        int blockSize = 0;
+        double audioSeconds = 0.0;
+        double renderSeconds = 0.0;
+        
+        double getRealtimeFactor() const { return renderSeconds > 0.0 ? audioSeconds / renderSeconds : 0.0; }
+        double getMaxBlockSeconds() const;
+        double getMeanBlockSeconds() const;
+        double getBlockPercentile(double percentile) const;
+    };
+    
+    explicit OfflineRenderer(const Settings& settings);
+    
+    // Decodes the whole sample (no streaming), then converts and builds the pyramid
+    juce::Result loadSample(const juce::File& file);
+    void loadSample(const juce::AudioBuffer<float>& audio, double sampleRate);
+    
+    // The XML getStateInformation writes, as text or as the binary blob itself.
+    // Engine parameters the state lacks take the plugin's defaults, with a warning.
+    juce::Result loadState(const juce::File& file);
+    juce::Result applyState(const juce::XmlElement& state);
+    
+    // Engine parameters directly, without a state (effects stay as they are)
+    void setParams(const GranularEngine::Params& newParams) { params = newParams; }
+    
+    // The sample the state refers to, if any
+    const juce::String& getStateSamplePath() const { return stateSamplePath; }
+    
+    // What the last applyState() had to fill in
+    const juce::StringArray& getStateWarnings() const { return stateWarnings; }
+    
+    // Renders events (timestamps in seconds) and the tail after them into a stereo buffer
+    Timing render(const juce::MidiMessageSequence& events, juce::AudioBuffer<float>& output);
+    
+    static juce::Result readMidiFile(const juce::File& file, juce::MidiMessageSequence& events);
+    static juce::Result readWavFile(const juce::File& file, juce::AudioBuffer<float>& audio);
+    static juce::Result writeWavFile(const juce::File& file, const juce::AudioBuffer<float>& audio, double sampleRate, int bitsPerSample);
+
+private:
+    Settings settings;
+    juce::AudioFormatManager formats;
+    GrainSource::Ptr source;
+    GranularEngine engine;
+    EffectsChain effects;
+    
+    // From the state; the plugin's defaults for the parameters it may leave out
+    GranularEngine::Params params;
+    int grainBudget = grainBudgetSizes[3];
+    float level = 0.8f;
+    float delayMix = 0.0f;
+    float reverbMix = 0.0f;
+    juce::String stateSamplePath;
+    juce::StringArray stateWarnings;
+    
+    double getTailSeconds() const;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OfflineRenderer)
+};
@@ -14,7 +14,7 @@ namespace Params {
     static constexpr const char* Spray         = "spray";           // 0..1 position randomization (alias for texture)
     static constexpr const char* Jitter        = "jitter";          // 0..1 timing randomization
     static constexpr const char* PitchJitter   = "pitchJitter";     // 0..1 pitch randomization per grain
-    static constexpr const char* GrainShape    = "grainShape";      // 0=Hann, 1=Triangle, 2=Square, 3=Gauss
+    static constexpr const char* GrainShape    = "grainShape";      // 0=Hann, 1=Triangle, 2=Square, 3=Gauss, 4=Trapezoid, 5=Tukey
     static constexpr const char* LoopMode      = "loopMode";        // 0=Forward, 1=Backward, 2=PingPong
     static constexpr const char* Glide         = "glide";           // 0..1 portamento time
     
@@ -53,6 +53,13 @@ namespace Params {
     static constexpr const char* ChorusAmount  = "chorusAmount";    // 0..1 chorus widening
     static constexpr const char* UnisonVoices  = "unisonVoices";    // 1..8 unison voices
     
+    // Rendering
+    static constexpr const char* Quality       = "quality";         // 0=Draft (linear), 1=Live (cubic), 2=Render (sinc)
+    static constexpr const char* MultiCore     = "multiCore";       // bool: render voices on worker threads
+    static constexpr const char* GrainBudget   = "grainBudget";     // index into grainBudgetSizes (EngineParameters.h)
+    static constexpr const char* Adaptive      = "adaptive";        // bool: lower quality when the block deadline gets close
+    static constexpr const char* Seed          = "seed";            // 0 = random per note, 1..65535 = reproducible
+    
     // Legacy parameters for compatibility
     static constexpr const char* Mix           = "mix";             // 0..1 (now always 1.0 for granular)
     static constexpr const char* Level         = "level";           // 0..1 master level
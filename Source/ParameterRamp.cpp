@@ -0,0 +1,108 @@
+#include "ParameterRamp.h"
+
+namespace {
+    // One-pole ramps snap once they are this close (relative to the target)
+    constexpr float settleThreshold = 1.0e-5f;
+    
+    bool hasSettled(float value, float target)
+    {
+        return std::abs(value - target) <= settleThreshold * juce::jmax(1.0f, std::abs(target));
+    }
+}
+
+void ParameterRamp::prepare(double sampleRate, int maximumBlockSize, double rampSeconds, Shape rampShape)
+{
+    shape = rampShape;
+    values.assign((size_t)juce::jmax(1, maximumBlockSize), target);
+    rampSamples = juce::jmax(0, juce::roundToInt(rampSeconds * sampleRate));
+    
+    decay.clear();
+    if (shape == Shape::onePole && rampSamples > 0)
+    {
+        const double retain = std::exp(-1.0 / (double)rampSamples);
+        double remaining = 1.0;
+        decay.resize(values.size());
+        for (auto& d : decay)
+        {
+            remaining *= retain;
+            d = (float)remaining;
+        }
+    }
+    
+    setCurrentAndTarget(target);
+}
+
+void ParameterRamp::setTarget(float newTarget)
+{
+    if (newTarget == target)
+        return;
+        
+    target = newTarget;
+    
+    if (shape == Shape::linear)
+    {
+        if (rampSamples > 0)
+        {
+            step = (target - current) / (float)rampSamples;
+            stepsRemaining = rampSamples;
+        }
+        else
+        {
+            current = target;
+        }
+    }
+    else if (decay.empty())
+    {
+        current = target;
+    }
+}
+
+void ParameterRamp::setCurrentAndTarget(float value)
+{
+    current = target = value;
+    stepsRemaining = 0;
+}
+
+const float* ParameterRamp::process(int numSamples)
+{
+    jassert(numSamples <= (int)values.size());
+    numSamples = juce::jmin(numSamples, (int)values.size());
+    float* out = values.data();
+    
+    if (!isSmoothing() || numSamples <= 0)
+    {
+        juce::FloatVectorOperations::fill(out, target, numSamples);
+        return out;
+    }
+    
+    if (shape == Shape::linear)
+    {
+        const int ramped = juce::jmin(numSamples, stepsRemaining);
+        const float start = current;
+        for (int i = 0; i < ramped; ++i)
+            out[i] = start + step * (float)(i + 1);
+            
+        stepsRemaining -= ramped;
+        if (stepsRemaining == 0)
+        {
+            // Land exactly on the target whatever the rounding
+            current = target;
+            if (ramped > 0)
+                out[ramped - 1] = target;
+            juce::FloatVectorOperations::fill(out + ramped, target, numSamples - ramped);
+        }
+        else
+        {
+            current = out[numSamples - 1];
+        }
+    }
+    else
+    {
+        // target + (current - target) * decay[i], in two vector passes
+        juce::FloatVectorOperations::copyWithMultiply(out, decay.data(), current - target, numSamples);
+        juce::FloatVectorOperations::add(out, target, numSamples);
+        current = hasSettled(out[numSamples - 1], target) ? target : out[numSamples - 1];
+    }
+    
+    return out;
+}
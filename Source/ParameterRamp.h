@@ -0,0 +1,42 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Smooths one parameter towards its latest value, a block at a time
+// process() writes the value for every sample of the next block into a buffer
+// sized in prepare(), so consumers read ramp[offset] wherever they need it.
+// Linear ramps reach the target in a fixed time; one-pole ramps approach it
+// exponentially from a precomputed decay curve. Either way a block costs one
+// vectorised pass, and a settled ramp is a plain fill.
+class ParameterRamp {
+public:
+    enum class Shape { linear, onePole };
+    
+    // Not real-time safe: sizes the buffers. rampSeconds is the ramp length for
+    // linear ramps and the time constant for one-pole ramps.
+    void prepare(double sampleRate, int maximumBlockSize, double rampSeconds, Shape rampShape);
+    
+    void setTarget(float newTarget);
+    
+    // Jumps straight to value with no ramp
+    void setCurrentAndTarget(float value);
+    
+    // Values for the next numSamples samples (at most the prepared block size)
+    const float* process(int numSamples);
+    
+    float getCurrentValue() const { return current; }
+    float getTargetValue() const { return target; }
+    bool isSmoothing() const { return current != target; }
+    int getMaximumBlockSize() const { return (int)values.size(); }
+
+private:
+    Shape shape = Shape::linear;
+    std::vector<float> values;
+    std::vector<float> decay;      // One-pole: remaining distance after i + 1 samples
+    float current = 0.0f;
+    float target = 0.0f;
+    
+    // Linear only
+    int rampSamples = 0;
+    int stepsRemaining = 0;
+    float step = 0.0f;
+};
@@ -0,0 +1,188 @@
+#include "PerformancePanel.h"
+
+PerformancePanel::PerformancePanel(PerformanceTelemetry& source)
+    : telemetry(source)
+{
+    drained.resize(PerformanceTelemetry::capacity);
+    recent.resize(numRecentBlocks);
+    columns.resize(numColumns);
+    sortScratch.reserve(numRecentBlocks);
+    telemetry.attachReader();
+}
+
+PerformancePanel::~PerformancePanel()
+{
+    telemetry.detachReader();
+}
+
+void PerformancePanel::update()
+{
+    const int numDrained = telemetry.pop(drained.data(), (int)drained.size());
+    
+    // One graph column per drain
+    Column column;
+    int numActive = 0;
+    for (int i = 0; i < numDrained; ++i)
+    {
+        const auto& metrics = drained[(size_t)i];
+        column.xrunSuspect |= metrics.xrunSuspect;
+        if (metrics.idle)
+            continue;
+        
+        column.idle = false;
+        column.maxLoad = juce::jmax(column.maxLoad, metrics.deadlineFraction);
+        column.meanLoad += metrics.deadlineFraction;
+        column.meanGrains += (float)metrics.activeGrains;
+        column.maxVoices = juce::jmax(column.maxVoices, metrics.activeVoices);
+        ++numActive;
+        
+        recent[(size_t)recentNext] = metrics;
+        recentNext = (recentNext + 1) % numRecentBlocks;
+        recentCount = juce::jmin(recentCount + 1, numRecentBlocks);
+    }
+    
+    if (numActive > 0)
+    {
+        column.meanLoad /= (float)numActive;
+        column.meanGrains /= (float)numActive;
+    }
+    columns[(size_t)columnNext] = column;
+    columnNext = (columnNext + 1) % numColumns;
+    
+    load = summarise([](const BlockMetrics& m) { return m.deadlineFraction * 100.0f; });
+    renderMs = summarise([](const BlockMetrics& m) { return m.renderSeconds * 1000.0f; });
+    grains = summarise([](const BlockMetrics& m) { return (float)m.activeGrains; });
+    voices = summarise([](const BlockMetrics& m) { return (float)m.activeVoices; });
+    
+    // Rates over the blocks behind the readouts
+    double seconds = 0.0, spawned = 0.0, culled = 0.0;
+    for (int i = 0; i < recentCount; ++i)
+    {
+        const auto& metrics = recent[(size_t)i];
+        seconds += metrics.blockSeconds;
+        spawned += metrics.grainsSpawned;
+        culled += metrics.grainsCulled;
+    }
+    spawnedPerSecond = seconds > 0.0 ? (float)(spawned / seconds) : 0.0f;
+    culledPerSecond = seconds > 0.0 ? (float)(culled / seconds) : 0.0f;
+    
+    if (isVisible())
+        repaint();
+}
+
+PerformancePanel::Summary PerformancePanel::summarise(const std::function<float(const BlockMetrics&)>& value)
+{
+    Summary summary;
+    if (recentCount == 0)
+        return summary;
+    
+    sortScratch.clear();
+    for (int i = 0; i < recentCount; ++i)
+        sortScratch.push_back(value(recent[(size_t)i]));
+    
+    summary.min = *std::min_element(sortScratch.begin(), sortScratch.end());
+    summary.max = *std::max_element(sortScratch.begin(), sortScratch.end());
+    summary.mean = std::accumulate(sortScratch.begin(), sortScratch.end(), 0.0f) / (float)recentCount;
+    
+    // Nearest rank
+    const auto rank = (size_t)juce::jlimit(0, recentCount - 1, (int)std::ceil(0.99 * recentCount) - 1);
+    std::nth_element(sortScratch.begin(), sortScratch.begin() + (std::ptrdiff_t)rank, sortScratch.end());
+    summary.p99 = sortScratch[rank];
+    return summary;
+}
+
+void PerformancePanel::paint(juce::Graphics& g)
+{
+    auto bounds = getLocalBounds().toFloat();
+    g.setColour(juce::Colour::fromRGB(25, 25, 25).withAlpha(0.95f));
+    g.fillRoundedRectangle(bounds, 8.0f);
+    g.setColour(juce::Colour::fromRGB(255, 120, 120).withAlpha(0.7f));
+    g.drawRoundedRectangle(bounds.reduced(1.0f), 8.0f, 1.5f);
+    
+    auto area = bounds.reduced(12.0f);
+    auto text = area.removeFromLeft(300.0f);
+    
+    g.setColour(juce::Colour::fromRGB(200, 200, 200));
+    g.setFont(juce::FontOptions(11.0f).withStyle("Bold"));
+    g.drawText("PERFORMANCE", text.removeFromTop(18.0f), juce::Justification::centredLeft);
+    
+    auto row = [&](const juce::String& label, const juce::String& values) {
+        auto line = text.removeFromTop(16.0f);
+        g.setColour(juce::Colour::fromRGB(140, 140, 140));
+        g.drawText(label, line.removeFromLeft(70.0f), juce::Justification::centredLeft);
+        g.setColour(juce::Colour::fromRGB(200, 200, 200));
+        g.drawText(values, line, juce::Justification::centredLeft);
+    };
+    auto describe = [](const Summary& s, int decimals) {
+        return juce::String(s.min, decimals) + " / " + juce::String(s.mean, decimals) + " / "
+             + juce::String(s.max, decimals) + " / " + juce::String(s.p99, decimals);
+    };
+    
+    g.setFont(juce::FontOptions(10.0f));
+    row("", "min / avg / max / p99");
+    row("Load %", describe(load, 1));
+    row("Block ms", describe(renderMs, 3));
+    row("Grains", describe(grains, 0));
+    row("Voices", describe(voices, 0));
+    text.removeFromTop(6.0f);
+    row("Spawned", juce::String(juce::roundToInt(spawnedPerSecond)) + " /s");
+    row("Culled", juce::String(juce::roundToInt(culledPerSecond)) + " /s");
+    row("Xruns?", juce::String(telemetry.getNumXrunSuspects()) + " suspect blocks");
+    if (telemetry.getNumDropped() > 0)
+        row("Dropped", juce::String(telemetry.getNumDropped()) + " records");
+    
+    // Load against the deadline (100% is the top), worst block per column; grains below
+    area.removeFromLeft(12.0f);
+    auto loadArea = area.removeFromTop(area.getHeight() * 0.6f).reduced(0.0f, 2.0f);
+    drawGraph(g, loadArea, "Load (worst block)", 1.0f, [](const Column& c) { return c.maxLoad; }, juce::Colour::fromRGB(255, 120, 120));
+    
+    float maxGrains = 1.0f;
+    for (const auto& c : columns)
+        maxGrains = juce::jmax(maxGrains, c.meanGrains);
+    drawGraph(g, area.reduced(0.0f, 2.0f), "Grains (" + juce::String(juce::roundToInt(maxGrains)) + " max)", maxGrains,
+              [](const Column& c) { return c.meanGrains; }, juce::Colour::fromRGB(120, 200, 255));
+}
+
+void PerformancePanel::drawGraph(juce::Graphics& g, juce::Rectangle<float> area, const juce::String& title, float maxValue,
+                                 const std::function<float(const Column&)>& value, juce::Colour colour) const
+{
+    g.setColour(juce::Colour::fromRGB(40, 40, 40));
+    g.fillRoundedRectangle(area, 4.0f);
+    
+    const float step = area.getWidth() / (float)(numColumns - 1);
+    juce::Path path;
+    bool drawing = false;
+    
+    // Oldest on the left; idle columns break the line, suspected xruns get a marker
+    for (int i = 0; i < numColumns; ++i)
+    {
+        const auto& column = columns[(size_t)((columnNext + i) % numColumns)];
+        const float x = area.getX() + step * (float)i;
+        
+        if (column.xrunSuspect)
+        {
+            g.setColour(juce::Colour::fromRGB(255, 220, 0).withAlpha(0.6f));
+            g.fillRect(x - 1.0f, area.getY(), 2.0f, area.getHeight());
+        }
+        
+        if (column.idle)
+        {
+            drawing = false;
+            continue;
+        }
+        
+        const float y = area.getBottom() - area.getHeight() * juce::jlimit(0.0f, 1.0f, value(column) / maxValue);
+        if (drawing)
+            path.lineTo(x, y);
+        else
+            path.startNewSubPath(x, y);
+        drawing = true;
+    }
+    
+    g.setColour(colour);
+    g.strokePath(path, juce::PathStrokeType(1.5f));
+    
+    g.setColour(juce::Colour::fromRGB(140, 140, 140));
+    g.setFont(juce::FontOptions(10.0f));
+    g.drawText(title, area.reduced(6.0f, 2.0f), juce::Justification::topLeft);
+}
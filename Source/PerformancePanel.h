@@ -0,0 +1,57 @@
+#pragma once
+#include <JuceHeader.h>
+#include "PerformanceTelemetry.h"
+
+// Collapsible view of the processor's per-block telemetry
+// The editor's timer drains the ring into two histories: the most recent blocks,
+// for the min/avg/max/p99 readouts, and one column per drain, for the scrolling
+// graphs of load and grains. Idle blocks show as gaps in the graphs and are left
+// out of the readouts.
+class PerformancePanel : public juce::Component {
+public:
+    // Attached as the telemetry's reader for its whole life, so blocks are only
+    // published while an editor is open
+    explicit PerformancePanel(PerformanceTelemetry& telemetry);
+    ~PerformancePanel() override;
+    
+    // Message thread, from the editor's timer. Drains even while hidden, so the ring
+    // doesn't fill and drop records; repaints only when visible.
+    void update();
+    
+    void paint(juce::Graphics&) override;
+
+private:
+    static constexpr int numRecentBlocks = 2048;   // Behind the readouts
+    static constexpr int numColumns = 150;         // Timer ticks across the graphs
+    
+    struct Column {
+        float maxLoad = 0.0f;       // Fraction of the deadline, worst block
+        float meanLoad = 0.0f;
+        float meanGrains = 0.0f;
+        int maxVoices = 0;
+        bool xrunSuspect = false;
+        bool idle = true;
+    };
+    
+    struct Summary {
+        float min = 0.0f, mean = 0.0f, max = 0.0f, p99 = 0.0f;
+    };
+    
+    PerformanceTelemetry& telemetry;
+    std::vector<BlockMetrics> drained;  // One ring's worth, reused every update
+    std::vector<BlockMetrics> recent;   // Circular, newest at recentNext - 1
+    int recentNext = 0, recentCount = 0;
+    std::vector<Column> columns;        // Circular, newest at columnNext - 1
+    int columnNext = 0;
+    std::vector<float> sortScratch;
+    
+    // Readouts, refreshed by update()
+    Summary load, renderMs, grains, voices;
+    float spawnedPerSecond = 0.0f, culledPerSecond = 0.0f;
+    
+    Summary summarise(const std::function<float(const BlockMetrics&)>& value);
+    void drawGraph(juce::Graphics& g, juce::Rectangle<float> area, const juce::String& title, float maxValue,
+                   const std::function<float(const Column&)>& value, juce::Colour colour) const;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PerformancePanel)
+};
@@ -0,0 +1,91 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Per-block metrics from the audio thread to the editor
+// The audio thread pushes one record per processed block into a fixed ring
+// (juce::AbstractFifo: one producer, one consumer, no locks or allocation).
+// When the reader falls behind, new records are dropped and counted rather than
+// overwriting ones it may be reading. The editor drains the ring on its timer;
+// with no reader attached (editor closed) nothing is published.
+struct BlockMetrics {
+    float renderSeconds = 0.0f;     // Engine and effects work for the block
+    float blockSeconds = 0.0f;      // Duration of the block's audio: its deadline
+    float deadlineFraction = 0.0f;  // renderSeconds over blockSeconds
+    int activeVoices = 0;
+    int activeGrains = 0;
+    int grainsSpawned = 0;
+    int grainsCulled = 0;
+    bool idle = false;              // Skipped: nothing sounding
+    bool xrunSuspect = false;       // Overran its deadline, or the host called late (see push)
+};
+
+class PerformanceTelemetry {
+public:
+    static constexpr int capacity = 4096; // About 2.7 s of 32-sample blocks at 48 kHz
+    
+    // Audio thread, once per block. callbackTicks is when the block started; a start
+    // more than two block lengths after the previous one also marks the block as a
+    // suspected xrun, since the host (or something before us) missed a deadline.
+    void push(BlockMetrics metrics, juce::int64 callbackTicks)
+    {
+        // Nobody would drain it; forget the last callback so reattaching isn't taken for a late one
+        if (numReaders.load(std::memory_order_acquire) == 0)
+        {
+            lastCallbackTicks = 0;
+            return;
+        }
+        
+        if (lastCallbackTicks != 0)
+        {
+            const double gap = juce::Time::highResolutionTicksToSeconds(callbackTicks - lastCallbackTicks);
+            metrics.xrunSuspect |= gap > 2.0 * (double)lastBlockSeconds;
+        }
+        metrics.xrunSuspect |= metrics.deadlineFraction > 1.0f;
+        lastCallbackTicks = callbackTicks;
+        lastBlockSeconds = metrics.blockSeconds;
+        
+        if (metrics.xrunSuspect)
+            xrunSuspects.fetch_add(1, std::memory_order_relaxed);
+        
+        const auto scope = fifo.write(1);
+        if (scope.blockSize1 > 0)
+            records[(size_t)scope.startIndex1] = metrics;
+        else
+            dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    // Message thread: a reader that drains the ring regularly, from attach until detach.
+    // Attaching discards whatever was left from the previous reader.
+    void attachReader()
+    {
+        numReaders.fetch_add(1, std::memory_order_acq_rel);
+        fifo.finishedRead(fifo.getNumReady());
+    }
+    void detachReader() { numReaders.fetch_sub(1, std::memory_order_acq_rel); }
+    
+    // Message thread; returns how many records were copied
+    int pop(BlockMetrics* destination, int maxRecords)
+    {
+        const auto scope = fifo.read(maxRecords);
+        for (int i = 0; i < scope.blockSize1; ++i)
+            destination[i] = records[(size_t)(scope.startIndex1 + i)];
+        for (int i = 0; i < scope.blockSize2; ++i)
+            destination[scope.blockSize1 + i] = records[(size_t)(scope.startIndex2 + i)];
+        return scope.blockSize1 + scope.blockSize2;
+    }
+    
+    // Running totals since construction; safe from any thread
+    juce::int64 getNumDropped() const { return dropped.load(std::memory_order_relaxed); }
+    juce::int64 getNumXrunSuspects() const { return xrunSuspects.load(std::memory_order_relaxed); }
+
+private:
+    juce::AbstractFifo fifo { capacity };
+    std::array<BlockMetrics, capacity> records;
+    std::atomic<juce::int64> dropped { 0 };
+    std::atomic<juce::int64> xrunSuspects { 0 };
+    std::atomic<int> numReaders { 0 };
+    
+    // Audio thread only
+    juce::int64 lastCallbackTicks = 0;
+    float lastBlockSeconds = 0.0f;
+};
@@ -5,7 +5,8 @@ static juce::Colour accent()           { return juce::Colour::fromRGB(240, 80, 9
 static juce::Colour accent2()          { return juce::Colour::fromRGB(120, 200, 255); }
 
 Dkash47GranularSynthAudioProcessorEditor::Dkash47GranularSynthAudioProcessorEditor(Dkash47GranularSynthAudioProcessor& p)
-    : juce::AudioProcessorEditor(&p), processor(p), thumbnail(1024, thumbFormats, thumbCache)
+    : juce::AudioProcessorEditor(&p), processor(p), thumbnail(1024, thumbFormats, thumbCache),
+      performancePanel(p.getTelemetry())
 {
     setResizable(false, false);
     setSize(1200, 750);  // More compact size while keeping readability
@@ -65,6 +66,41 @@ Dkash47GranularSynthAudioProcessorEditor::Dkash47GranularSynthAudioProcessorEdit
     lfoTarget.addItem("Size", 3);
     lfoTarget.setSelectedId(1);
 
+    // Interpolation quality (offline renders always use Render)
+    quality.addItem("Draft", 1);
+    quality.addItem("Live", 2);
+    quality.addItem("Render", 3);
+    quality.setSelectedId(2);
+
+    // Source pyramid memory budget (takes effect on the next sample load)
+    static constexpr int pyramidBudgetsMB[] = { 0, 32, 128, 512 };
+    for (int i = 0; i < (int) std::size(pyramidBudgetsMB); ++i)
+        pyramidBudget.addItem(pyramidBudgetsMB[i] == 0 ? juce::String("Mips: Off") : "Mips: " + juce::String(pyramidBudgetsMB[i]) + " MB", i + 1);
+    for (int i = 0; i < (int) std::size(pyramidBudgetsMB); ++i)
+        if (pyramidBudgetsMB[i] <= processor.getPyramidMemoryBudget())
+            pyramidBudget.setSelectedId(i + 1, juce::dontSendNotification);
+    pyramidBudget.onChange = [this] {
+        processor.setPyramidMemoryBudget(pyramidBudgetsMB[pyramidBudget.getSelectedId() - 1]);
+    };
+
+    // Source storage format (takes effect on the next sample load)
+    sourceFormat.addItem("Store: Float", grainSampleFloat32 + 1);
+    sourceFormat.addItem("Store: 16-bit", grainSampleInt16 + 1);
+    sourceFormat.addItem("Store: Half", grainSampleFloat16 + 1);
+    sourceFormat.setSelectedId(processor.getSourceFormat() + 1, juce::dontSendNotification);
+    sourceFormat.onChange = [this] {
+        processor.setSourceFormat(sourceFormat.getSelectedId() - 1);
+    };
+
+    // Engine-wide grain budget
+    for (int i = 0; i < (int) processor.grainBudgetSizes.size(); ++i)
+    {
+        const int size = processor.grainBudgetSizes[(size_t) i];
+        grainBudget.addItem(size == 0 ? juce::String("Grains: All") : "Grains: " + juce::String(size), i + 1);
+    }
+    grainStatus.setJustificationType(juce::Justification::centredLeft);
+    grainStatus.setColour(juce::Label::textColourId, juce::Colour::fromRGB(180, 180, 180));
+
     // Add all controls to editor
     for (auto* s : { &grainSize, &density, &texture, &pitch, &position, &reverse,
                      &stereoWidth, &grainPitch, &freeze, &filterCutoff, &filterRes,
@@ -74,9 +110,21 @@ Dkash47GranularSynthAudioProcessorEditor::Dkash47GranularSynthAudioProcessorEdit
         addAndMakeVisible(s);
     
     addAndMakeVisible(lfoTarget);
+    addAndMakeVisible(quality);
+    addAndMakeVisible(pyramidBudget);
+    addAndMakeVisible(sourceFormat);
+    addAndMakeVisible(grainBudget);
+    addAndMakeVisible(grainStatus);
     addAndMakeVisible(testTone);
+    addAndMakeVisible(multiCore);
+    addAndMakeVisible(adaptive);
     addAndMakeVisible(lfoVisualizer);
     
+    // Performance panel, collapsed until asked for
+    addChildComponent(performancePanel);
+    perfToggle.onClick = [this] { performancePanel.setVisible(perfToggle.getToggleState()); };
+    addAndMakeVisible(perfToggle);
+    
     midiLabel.setJustificationType(juce::Justification::centredLeft);
     midiLabel.setColour(juce::Label::textColourId, accent2());
     addAndMakeVisible(midiLabel);
@@ -104,6 +152,8 @@ Dkash47GranularSynthAudioProcessorEditor::Dkash47GranularSynthAudioProcessorEdit
     lfoRateA      = std::make_unique<SliderAttachment>(apvts, Params::LFORate,      lfoRate);
     lfoAmountA    = std::make_unique<SliderAttachment>(apvts, Params::LFOAmount,    lfoAmount);
     lfoTargetA    = std::make_unique<ComboBoxAttachment>(apvts, Params::LFOTarget,  lfoTarget);
+    qualityA      = std::make_unique<ComboBoxAttachment>(apvts, Params::Quality,    quality);
+    grainBudgetA  = std::make_unique<ComboBoxAttachment>(apvts, Params::GrainBudget, grainBudget);
     
     reverbMixA    = std::make_unique<SliderAttachment>(apvts, Params::ReverbMix,    reverbMix);
     delayMixA     = std::make_unique<SliderAttachment>(apvts, Params::DelayMix,     delayMix);
@@ -113,6 +163,8 @@ Dkash47GranularSynthAudioProcessorEditor::Dkash47GranularSynthAudioProcessorEdit
     levelA        = std::make_unique<SliderAttachment>(apvts, Params::Level,        level);
     
     testToneA     = std::make_unique<ButtonAttachment>(apvts, Params::TestTone,     testTone);
+    multiCoreA    = std::make_unique<ButtonAttachment>(apvts, Params::MultiCore,    multiCore);
+    adaptiveA     = std::make_unique<ButtonAttachment>(apvts, Params::Adaptive,     adaptive);
 }
 
 void Dkash47GranularSynthAudioProcessorEditor::paint(juce::Graphics& g)
@@ -272,6 +324,15 @@ void Dkash47GranularSynthAudioProcessorEditor::paint(juce::Graphics& g)
         g.setColour(juce::Colour::fromRGB(100, 100, 100).withAlpha(dropTextAlpha * 0.5f));
         g.drawRoundedRectangle(wf.toFloat().reduced(20), 4.0f, 1.0f);
     }
+    
+    // A sample that couldn't be loaded; the previous one, if any, keeps playing
+    const auto loadError = processor.getSampleLoadError();
+    if (loadError.isNotEmpty())
+    {
+        g.setColour(juce::Colour::fromRGB(255, 120, 120));
+        g.setFont(juce::FontOptions(12.0f));
+        g.drawFittedText(loadError, wf.reduced(24, 8), juce::Justification::centredBottom, 1);
+    }
 
     // Enhanced section labels with Quanta-style reactive glow
     auto sectionBrightness = 160 + (int)(midiActivity * 40);
@@ -369,9 +430,12 @@ void Dkash47GranularSynthAudioProcessorEditor::filesDropped(const juce::StringAr
             lastFile = f;
             thumbnail.setSource(new juce::FileInputSource(f));
             repaint();
-            break;
+            return;
         }
     }
+    
+    // Shows why the last one didn't load
+    repaint();
 }
 
 void Dkash47GranularSynthAudioProcessorEditor::changeListenerCallback(juce::ChangeBroadcaster* source)
@@ -414,7 +478,7 @@ void Dkash47GranularSynthAudioProcessorEditor::timerCallback()
     // Check if sample was loaded and update thumbnail (less frequently)
     if (updateCounter % 5 == 0) // Only check every 5 timer callbacks
     {
-        if (processor.getSampleBuffer() != nullptr && thumbnail.getNumChannels() == 0)
+        if (processor.getSampleSource() != nullptr && thumbnail.getNumChannels() == 0)
         {
             auto currentPath = processor.getCurrentSamplePath();
             if (currentPath.isNotEmpty())
@@ -429,6 +493,21 @@ void Dkash47GranularSynthAudioProcessorEditor::timerCallback()
         }
     }
     
+    // Render load, governor level, grains dropped by the budget since the plugin was created and sample memory
+    if (updateCounter % 5 == 0)
+    {
+        const auto& governor = processor.getQualityGovernor();
+        juce::String status = "Load " + juce::String(juce::roundToInt(governor.getLoad() * 100.0f)) + "%";
+        if (governor.getLevel() > 0)
+            status << "  Q-" << governor.getLevel();
+        status << "  Culled " << processor.getNumCulledGrains();
+        status << "  " << juce::roundToInt((double) processor.getSourceMemoryBytes() / (1024.0 * 1024.0)) << " MB";
+        grainStatus.setText(status, juce::dontSendNotification);
+    }
+    
+    // Drain the per-block telemetry every tick, whether or not the panel is open
+    performancePanel.update();
+    
     // Update LFO visualizer with reactive effects
     float lfoValue = processor.engine.getCurrentLFOValue();
     lfoVisualizer.setLFOPhase(std::asin(lfoValue));
@@ -473,11 +552,20 @@ void Dkash47GranularSynthAudioProcessorEditor::resized()
     // Header area with title and controls
     auto headerArea = bounds.removeFromTop(60);
     testTone.setBounds(headerArea.removeFromRight(100).reduced(10));
-    midiLabel.setBounds(headerArea.removeFromLeft(300).withTrimmedTop(35));
+    multiCore.setBounds(headerArea.removeFromRight(100).reduced(10));
+    adaptive.setBounds(headerArea.removeFromRight(95).reduced(10));
+    perfToggle.setBounds(headerArea.removeFromRight(75).reduced(10));
+    quality.setBounds(headerArea.removeFromRight(110).reduced(10, 15));
+    pyramidBudget.setBounds(headerArea.removeFromRight(115).reduced(10, 15));
+    sourceFormat.setBounds(headerArea.removeFromRight(115).reduced(10, 15));
+    grainBudget.setBounds(headerArea.removeFromRight(115).reduced(10, 15));
+    midiLabel.setBounds(headerArea.removeFromLeft(185).withTrimmedTop(35));
+    grainStatus.setBounds(headerArea.withTrimmedTop(35));
     
     // Waveform area (like Quanta's main display)
     auto waveformArea = bounds.removeFromTop(220).reduced(margin);
     waveformBounds = waveformArea;
+    performancePanel.setBounds(waveformArea);
     
     // Position slider below waveform (like Quanta)
     auto positionArea = bounds.removeFromTop(50).reduced(margin + 40, 10);
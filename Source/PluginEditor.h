@@ -1,6 +1,7 @@
 #pragma once
 #include <JuceHeader.h>
 #include "ParameterIDs.h"
+#include "PerformancePanel.h"
 
 class Dkash47GranularSynthAudioProcessor;
 
@@ -218,6 +219,13 @@ private:
     juce::Slider lfoAmount   { juce::Slider::RotaryHorizontalVerticalDrag, juce::Slider::NoTextBox };
     juce::ComboBox lfoTarget;
     
+    // Rendering
+    juce::ComboBox quality;
+    juce::ComboBox pyramidBudget; // Not a parameter: a memory setting stored with the state
+    juce::ComboBox sourceFormat;  // Likewise
+    juce::ComboBox grainBudget;
+    juce::Label grainStatus;      // Render load, governor level, grains culled by the budget and source memory
+    
     // Effects Controls
     juce::Slider reverbMix   { juce::Slider::RotaryHorizontalVerticalDrag, juce::Slider::NoTextBox };
     juce::Slider delayMix    { juce::Slider::RotaryHorizontalVerticalDrag, juce::Slider::NoTextBox };
@@ -238,8 +246,8 @@ private:
                                       attackA, decayA, sustainA, releaseA,
                                       lfoRateA, lfoAmountA, reverbMixA, delayMixA,
                                       chorusAmountA, unisonVoicesA, levelA;
-    std::unique_ptr<ComboBoxAttachment> lfoTargetA;
-    std::unique_ptr<ButtonAttachment> testToneA;
+    std::unique_ptr<ComboBoxAttachment> lfoTargetA, qualityA, grainBudgetA;
+    std::unique_ptr<ButtonAttachment> testToneA, multiCoreA, adaptiveA;
 
     // Waveform
     juce::AudioThumbnailCache thumbCache { 5 };
@@ -258,6 +266,9 @@ private:
 
     // UI controls
     juce::ToggleButton testTone { "Test Tone" };
+    juce::ToggleButton multiCore { "Multi-core" };
+    juce::ToggleButton adaptive { "Adaptive" };
+    juce::ToggleButton perfToggle { "Perf" }; // Shows the performance panel over the waveform
     juce::Label midiLabel;
     
     // Enhanced LFO Visualization with reactive effects
@@ -334,6 +345,8 @@ private:
         float lfoPhase = 0.0f;
         float midiIntensity = 0.0f;
     } lfoVisualizer;
+    
+    PerformancePanel performancePanel;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Dkash47GranularSynthAudioProcessorEditor)
 };
@@ -5,18 +5,38 @@ Dkash47GranularSynthAudioProcessor::Dkash47GranularSynthAudioProcessor()
     : juce::AudioProcessor(BusesProperties().withOutput("Output", juce::AudioChannelSet::stereo(), true))
 {
     formats.registerBasicFormats();
+    
+    // Resolve parameter IDs once; the audio thread then only does atomic loads
+    for (const auto& [id, field, defaultValue] : engineParameterFields)
+    {
+        engineParamBindings.push_back({ apvts.getRawParameterValue(id), field });
+        
+        // The offline renderer falls back to the table's defaults; they must be the tree's
+        jassert(std::abs(apvts.getRawParameterValue(id)->load() - defaultValue) < 1.0e-4f);
+        juce::ignoreUnused(defaultValue);
+    }
+    
+    qualityParam   = apvts.getRawParameterValue(Params::Quality);
+    multiCoreParam = apvts.getRawParameterValue(Params::MultiCore);
+    grainBudgetParam = apvts.getRawParameterValue(Params::GrainBudget);
+    adaptiveParam  = apvts.getRawParameterValue(Params::Adaptive);
+    testToneParam  = apvts.getRawParameterValue(Params::TestTone);
+    levelParam     = apvts.getRawParameterValue(Params::Level);
+    delayMixParam  = apvts.getRawParameterValue(Params::DelayMix);
+    reverbMixParam = apvts.getRawParameterValue(Params::ReverbMix);
 }
 
 void Dkash47GranularSynthAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
     engine.prepare(sampleRate, samplesPerBlock);
-    delay.reset();
-    {
-        const float delaySamples = (float) juce::jlimit(1, (int) sampleRate, (int) (300.0 / 1000.0 * sampleRate));
-        delay.setDelay(delaySamples);
-    }
-    reverb.reset();
+    effects.prepare(sampleRate, samplesPerBlock, levelParam->load());
+    governor.prepare(sampleRate);
     updateFromParams();
+    
+    // Resident samples are converted to the session rate as they load; convert again for a new rate.
+    // Until the new copy is published, grains scale their step for the old one.
+    if (sampleRate != sourceTargetRate && currentSamplePath.isNotEmpty())
+        loadFile(juce::File(currentSamplePath));
 }
 
 bool Dkash47GranularSynthAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
@@ -28,6 +48,38 @@ bool Dkash47GranularSynthAudioProcessor::isBusesLayoutSupported(const BusesLayou
 void Dkash47GranularSynthAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midi)
 {
     juce::ScopedNoDenormals noDenormals;
+    const auto callbackTicks = juce::Time::getHighResolutionTicks();
+    
+    // Adopt a newly loaded sample, and tell the loader which old ones it may free
+    const auto* latestSource = sourceLoader.getPublished();
+    engine.updateSource(latestSource);
+    sourceLoader.acknowledge(engine.getOldestSourceInUse(), latestSource);
+    
+    // Idle: nothing sounding, no FX tail left and nothing to start one
+    if (midi.isEmpty() && effectsTailSamples <= 0 && !engine.hasActiveVoices() && testToneParam->load() <= 0.5f)
+    {
+        if (!idle)
+        {
+            // Drop the inaudible remainder so the next note starts from clean FX state
+            effects.reset();
+            lastPeak.store(0.0f);
+            idle = true;
+        }
+        buffer.clear();
+        
+        // Still reported, so the editor's graphs keep moving and late callbacks are seen
+        if (!isNonRealtime())
+        {
+            BlockMetrics metrics;
+            metrics.blockSeconds = (float)(buffer.getNumSamples() / getSampleRate());
+            metrics.idle = true;
+            telemetry.push(metrics, callbackTicks);
+        }
+        return;
+    }
+    idle = false;
+    
+    const auto blockStartTicks = juce::Time::getHighResolutionTicks();
     buffer.clear();
 
     // Update MIDI counters for UI feedback
@@ -57,14 +109,17 @@ void Dkash47GranularSynthAudioProcessor::processBlock(juce::AudioBuffer<float>&
     // Render granular synthesis
     engine.render(buffer, midi);
 
+    // Restart the FX tail countdown while voices sound
+    if (engine.hasActiveVoices())
+        effectsTailSamples = (int)(getEffectsTailSeconds() * getSampleRate());
+    else
+        effectsTailSamples -= buffer.getNumSamples();
+        
     // Calculate peak for metering
-    float peak = 0.0f;
-    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
-        for (int i = 0; i < buffer.getNumSamples(); ++i)
-            peak = std::max(peak, std::abs(buffer.getReadPointer(ch)[i]));
+    float peak = buffer.getMagnitude(0, buffer.getNumSamples());
 
     // Test tone / fallback (only if forced)
-    const bool forceTone = apvts.getRawParameterValue(Params::TestTone)->load() > 0.5f;
+    const bool forceTone = testToneParam->load() > 0.5f;
     if (forceTone)
     {
         auto* l = buffer.getWritePointer(0);
@@ -81,124 +136,94 @@ void Dkash47GranularSynthAudioProcessor::processBlock(juce::AudioBuffer<float>&
         peak = std::max(peak, 0.1f);
     }
 
-    // Apply master level
-    const float masterLevel = apvts.getRawParameterValue(Params::Level)->load();
-    buffer.applyGain(masterLevel);
-
-    // Simple effects
-    auto totalCh = buffer.getNumChannels();
-    auto numSamples = buffer.getNumSamples();
+    // Master level, delay and reverb
+    effects.process(buffer, levelParam->load(), delayMixParam->load(), reverbMixParam->load());
 
-    // Simple delay
-    const float delayMixAmount = apvts.getRawParameterValue(Params::DelayMix)->load();
-    if (delayMixAmount > 0.0f)
+    // Update peak meter
+    lastPeak.store(peak);
+    
+    const double renderSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - blockStartTicks);
+    
+    // Offline renders have no deadline and always run at full quality
+    if (adaptiveParam->load() > 0.5f && !isNonRealtime())
+        governor.update(renderSeconds, buffer.getNumSamples());
+    else if (governor.getLevel() != 0)
+        governor.reset();
+        
+    // Per-block metrics for the editor's performance panel
+    if (!isNonRealtime())
     {
-        for (int ch = 0; ch < totalCh; ++ch)
-        {
-            auto* d = buffer.getWritePointer(ch);
-            for (int i = 0; i < numSamples; ++i)
-            {
-                float delayed = delay.popSample(0);
-                float inp = d[i];
-                delay.pushSample(0, inp + delayed * delayFeedback);
-                d[i] = inp * (1.0f - delayMixAmount) + delayed * delayMixAmount;
-            }
-        }
+        const auto& stats = engine.getLastBlockStats();
+        BlockMetrics metrics;
+        metrics.renderSeconds = (float)renderSeconds;
+        metrics.blockSeconds = (float)(buffer.getNumSamples() / getSampleRate());
+        metrics.deadlineFraction = metrics.blockSeconds > 0.0f ? metrics.renderSeconds / metrics.blockSeconds : 0.0f;
+        metrics.activeVoices = stats.activeVoices;
+        metrics.activeGrains = stats.activeGrains;
+        metrics.grainsSpawned = stats.grainsSpawned;
+        metrics.grainsCulled = stats.grainsCulled;
+        telemetry.push(metrics, callbackTicks);
     }
+}
 
-    // Simple reverb
-    const float reverbAmount = apvts.getRawParameterValue(Params::ReverbMix)->load();
-    if (reverbAmount > 0.0f)
-    {
-        reverbParams.wetLevel = reverbAmount;
-        reverbParams.roomSize = 0.7f;
-        reverb.setParameters(reverbParams);
-        reverb.processStereo(buffer.getWritePointer(0), 
-                           buffer.getNumChannels() > 1 ? buffer.getWritePointer(1) : buffer.getWritePointer(0), 
-                           numSamples);
-    }
+double Dkash47GranularSynthAudioProcessor::getEffectsTailSeconds() const
+{
+    return effects.getTailSeconds(delayMixParam->load(), reverbMixParam->load());
+}
 
-    // Update peak meter
-    lastPeak.store(peak);
+double Dkash47GranularSynthAudioProcessor::getTailLengthSeconds() const
+{
+    // Voice release, then the effects ringing out
+    return apvts.getRawParameterValue(Params::Release)->load() / 1000.0 + getEffectsTailSeconds();
 }
 
 void Dkash47GranularSynthAudioProcessor::updateFromParams()
 {
-    // Create CPU-Optimized Ableton-style parameters
+    // Atomic loads only; the engine ignores snapshots that match the last one
     GranularEngine::Params p;
+    for (const auto& binding : engineParamBindings)
+        p.*(binding.field) = binding.value->load(std::memory_order_relaxed);
     
-    // Core granular parameters
-    p.grainSize     = apvts.getRawParameterValue(Params::GrainSize)->load();
-    p.density       = apvts.getRawParameterValue(Params::Density)->load();
-    p.texture       = apvts.getRawParameterValue(Params::Texture)->load();
-    p.pitch         = apvts.getRawParameterValue(Params::Pitch)->load();
-    p.position      = apvts.getRawParameterValue(Params::Position)->load();
-    p.reverse       = apvts.getRawParameterValue(Params::Reverse)->load();
+    // Offline bounces always get the sinc interpolator; live playback uses the chosen quality
+    p.quality       = isNonRealtime() ? 2.0f : qualityParam->load(std::memory_order_relaxed);
     
-    // CPU-Optimized Ableton-style features
-    p.scan          = apvts.getRawParameterValue(Params::Scan)->load();
-    p.spray         = apvts.getRawParameterValue(Params::Spray)->load();
-    p.jitter        = apvts.getRawParameterValue(Params::Jitter)->load();
-    p.pitchJitter   = apvts.getRawParameterValue(Params::PitchJitter)->load();
-    p.grainShape    = apvts.getRawParameterValue(Params::GrainShape)->load();
-    p.loopMode      = apvts.getRawParameterValue(Params::LoopMode)->load();
-    p.glide         = apvts.getRawParameterValue(Params::Glide)->load();
-    
-    // Advanced parameters
-    p.stereoWidth   = apvts.getRawParameterValue(Params::StereoWidth)->load();
-    p.grainPitch    = apvts.getRawParameterValue(Params::GrainPitch)->load();
-    p.freeze        = apvts.getRawParameterValue(Params::Freeze)->load();
-    p.filterCutoff  = apvts.getRawParameterValue(Params::FilterCutoff)->load();
-    p.filterRes     = apvts.getRawParameterValue(Params::FilterRes)->load();
-    p.filterType    = apvts.getRawParameterValue(Params::FilterType)->load();
-    p.formantShift  = apvts.getRawParameterValue(Params::FormantShift)->load();
-    p.randomSpread  = apvts.getRawParameterValue(Params::RandomSpread)->load();
-    p.grainAmp      = apvts.getRawParameterValue(Params::GrainAmp)->load();
-    
-    // Envelope
-    p.attack        = apvts.getRawParameterValue(Params::Attack)->load();
-    p.decay         = apvts.getRawParameterValue(Params::Decay)->load();
-    p.sustain       = apvts.getRawParameterValue(Params::Sustain)->load();
-    p.release       = apvts.getRawParameterValue(Params::Release)->load();
-    
-    // CPU-Optimized Enhanced Modulation System
-    p.lfoRate       = apvts.getRawParameterValue(Params::LFORate)->load();
-    p.lfoAmount     = apvts.getRawParameterValue(Params::LFOAmount)->load();
-    p.lfoTarget     = apvts.getRawParameterValue(Params::LFOTarget)->load();
-    p.lfoShape      = apvts.getRawParameterValue(Params::LFOShape)->load();
+    const int budgetIndex = juce::jlimit(0, (int)grainBudgetSizes.size() - 1, (int)grainBudgetParam->load(std::memory_order_relaxed));
+    int grainBudget = grainBudgetSizes[(size_t)budgetIndex];
     
-    // Second LFO (CPU-optimized)
-    p.lfo2Rate      = apvts.getRawParameterValue(Params::LFO2Rate)->load();
-    p.lfo2Amount    = apvts.getRawParameterValue(Params::LFO2Amount)->load();
-    p.lfo2Target    = apvts.getRawParameterValue(Params::LFO2Target)->load();
-    p.lfo2Shape     = apvts.getRawParameterValue(Params::LFO2Shape)->load();
-    
-    // New widening effects
-    p.chorusAmount  = apvts.getRawParameterValue(Params::ChorusAmount)->load();
-    p.unisonVoices  = apvts.getRawParameterValue(Params::UnisonVoices)->load();
+    // Under load the governor caps quality, unison, chorus and the grain budget
+    governor.apply(p, grainBudget);
     
     engine.setParams(p);
-
-    // Setup simple delay
-    const float delaySamples = (float) juce::jlimit(1, (int) getSampleRate(), (int) (200.0 / 1000.0 * getSampleRate()));
-    delay.setDelay(delaySamples);
-    delayFeedback = 0.4f;
-
-    // Set audio source
-    if (sampleBuffer)
-        engine.setSource(sampleBuffer.get(), fileSampleRate);
+    engine.setParallelRendering(multiCoreParam->load(std::memory_order_relaxed) > 0.5f);
+    engine.setGrainBudget(grainBudget);
 }
 
 bool Dkash47GranularSynthAudioProcessor::loadFile(const juce::File& f)
 {
     std::unique_ptr<juce::AudioFormatReader> r (formats.createReaderFor(f));
-    if (! r) return false;
-    auto newBuf = std::make_unique<juce::AudioBuffer<float>>((int) juce::jmax(1u, r->numChannels), (int) r->lengthInSamples);
-    r->read(newBuf.get(), 0, (int) r->lengthInSamples, 0, true, true);
-    sampleBuffer = std::move(newBuf);
-    fileSampleRate = r->sampleRate;
+    if (! r)
+    {
+        sampleLoadError = "Can't read " + f.getFileName();
+        return false;
+    }
+    
+    const double rate = r->sampleRate;
+    const double targetRate = getSampleRate();
+    
+    // Decoded (or opened for streaming) and resampled in the background; the audio thread switches over when it is ready
+    const auto result = sourceLoader.loadAsync(std::move(r), targetRate, (size_t) pyramidBudgetMB * 1024 * 1024, (GrainSampleFormat) sourceFormat,
+                                               (size_t) streamingThresholdMB * 1024 * 1024, (size_t) streamCacheMB * 1024 * 1024);
+    if (result.failed())
+    {
+        // The previous sample keeps playing, and stays the one saved with the state
+        sampleLoadError = f.getFileName() + ": " + result.getErrorMessage();
+        return false;
+    }
+    
+    fileSampleRate = rate;
     currentSamplePath = f.getFullPathName(); // Store path for state persistence
-    engine.setSource(sampleBuffer.get(), fileSampleRate);
+    sourceTargetRate = targetRate;
+    sampleLoadError.clear();
     return true;
 }
 
@@ -219,6 +244,9 @@ void Dkash47GranularSynthAudioProcessor::getStateInformation(juce::MemoryBlock&
         xml->setAttribute("sampleRate", fileSampleRate);
     }
     
+    xml->setAttribute("pyramidBudgetMB", pyramidBudgetMB);
+    xml->setAttribute("sourceFormat", sourceFormat);
+    
     copyXmlToBinary(*xml, destData);
 }
 
@@ -229,6 +257,10 @@ void Dkash47GranularSynthAudioProcessor::setStateInformation(const void* data, i
     {
         apvts.replaceState(juce::ValueTree::fromXml(*xml));
         
+        // Before the sample reload below, which builds the source with them
+        setPyramidMemoryBudget(xml->getIntAttribute("pyramidBudgetMB", pyramidBudgetMB));
+        setSourceFormat(xml->getIntAttribute("sourceFormat", sourceFormat));
+        
         // Restore sample file if path exists
         juce::String samplePath = xml->getStringAttribute("samplePath");
         if (samplePath.isNotEmpty())
@@ -273,7 +305,7 @@ juce::AudioProcessorValueTreeState::ParameterLayout Dkash47GranularSynthAudioPro
     p.push_back(std::make_unique<juce::AudioParameterFloat>(Params::PitchJitter, "Pitch Jitter", 
         juce::NormalisableRange<float>(0.0f, 1.0f, 0.001f), 0.0f));
     p.push_back(std::make_unique<juce::AudioParameterFloat>(Params::GrainShape, "Grain Shape", 
-        juce::NormalisableRange<float>(0.0f, 3.0f, 1.0f), 0.0f)); // 0=Hann, 1=Triangle, 2=Square, 3=Gauss
+        juce::NormalisableRange<float>(0.0f, 5.0f, 1.0f), 0.0f)); // 0=Hann, 1=Triangle, 2=Square, 3=Gauss, 4=Trapezoid, 5=Tukey
     p.push_back(std::make_unique<juce::AudioParameterFloat>(Params::LoopMode, "Loop Mode", 
         juce::NormalisableRange<float>(0.0f, 2.0f, 1.0f), 0.0f)); // 0=Forward, 1=Backward, 2=PingPong
     p.push_back(std::make_unique<juce::AudioParameterFloat>(Params::Glide, "Glide", 
@@ -343,6 +375,16 @@ juce::AudioProcessorValueTreeState::ParameterLayout Dkash47GranularSynthAudioPro
     p.push_back(std::make_unique<juce::AudioParameterFloat>(Params::UnisonVoices, "Unison", 
         juce::NormalisableRange<float>(1.0f, 8.0f, 1.0f), 1.0f));
     
+    // Rendering quality (interpolation); offline renders always use Render
+    p.push_back(std::make_unique<juce::AudioParameterFloat>(Params::Quality, "Quality", 
+        juce::NormalisableRange<float>(0.0f, 2.0f, 1.0f), 1.0f)); // 0=Draft, 1=Live, 2=Render
+    p.push_back(std::make_unique<juce::AudioParameterBool>(Params::MultiCore, "Multi-core", false));
+    p.push_back(std::make_unique<juce::AudioParameterFloat>(Params::GrainBudget, "Grain Budget", 
+        juce::NormalisableRange<float>(0.0f, (float)(grainBudgetSizes.size() - 1), 1.0f), 3.0f)); // 128 grains
+    p.push_back(std::make_unique<juce::AudioParameterBool>(Params::Adaptive, "Adaptive Quality", false));
+    p.push_back(std::make_unique<juce::AudioParameterFloat>(Params::Seed, "Seed", 
+        juce::NormalisableRange<float>(0.0f, 65535.0f, 1.0f), 0.0f)); // 0 = random per note
+    
     // Legacy/Utility
     p.push_back(std::make_unique<juce::AudioParameterFloat>(Params::Mix, "Mix", 
         juce::NormalisableRange<float>(0.0f, 1.0f, 0.001f), 1.0f));
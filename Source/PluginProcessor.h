@@ -2,6 +2,11 @@
 #include <JuceHeader.h>
 #include "GranularEngine.h"
 #include "ParameterIDs.h"
+#include "EngineParameters.h"
+#include "QualityGovernor.h"
+#include "GrainSourceLoader.h"
+#include "EffectsChain.h"
+#include "PerformanceTelemetry.h"
 
 class Dkash47GranularSynthAudioProcessor : public juce::AudioProcessor
 {
@@ -23,7 +28,7 @@ public:
     bool acceptsMidi() const override { return true; }
     bool producesMidi() const override { return false; }
     bool isMidiEffect() const override { return false; }
-    double getTailLengthSeconds() const override { return 0.0; }
+    double getTailLengthSeconds() const override;
 
     int getNumPrograms() override { return 1; }
     int getCurrentProgram() override { return 0; }
@@ -36,13 +41,30 @@ public:
 
     // File loading
     bool loadFile(const juce::File&);
+    
+    // Extra memory the source pyramid (octave-down copies) may use; applies from the next load
+    void setPyramidMemoryBudget(int megabytes) { pyramidBudgetMB = juce::jmax(0, megabytes); }
+    int getPyramidMemoryBudget() const { return pyramidBudgetMB; }
+    
+    // How resident samples are stored (GrainSampleFormat); applies from the next load
+    void setSourceFormat(int format) { sourceFormat = juce::jlimit(0, (int) numGrainSampleFormats - 1, format); }
+    int getSourceFormat() const { return sourceFormat; }
+    size_t getSourceMemoryBytes() const { return sourceLoader.getMemoryBytes(); }
+
+    // Grain Budget parameter choices (see EngineParameters.h)
+    static constexpr auto grainBudgetSizes = ::grainBudgetSizes;
+    juce::int64 getNumCulledGrains() const { return engine.getNumCulledGrains(); }
+    const QualityGovernor& getQualityGovernor() const { return governor; }
+    
+    // Per-block metrics; only the editor may read from it
+    PerformanceTelemetry& getTelemetry() { return telemetry; }
 
     // Params
     juce::AudioProcessorValueTreeState apvts { *this, nullptr, "Params", createParameterLayout() };
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
     // Accessors for UI
-    const juce::AudioBuffer<float>* getSampleBuffer() const { return sampleBuffer.get(); }
+    const GrainSource* getSampleSource() const { return sourceLoader.getPublished(); }
     float getLastPeak() const { return lastPeak.load(); }
     int getMidiCounter() const { return midiCounter.load(); }
     float getPlayheadNorm() const { return engine.getPlayheadNorm(); }
@@ -50,6 +72,7 @@ public:
     int getLastMidiVel() const { return lastMidiVel.load(); }
     int getLastMidiChan() const { return lastMidiChan.load(); }
     juce::String getCurrentSamplePath() const { return currentSamplePath; }
+    juce::String getSampleLoadError() const { return sampleLoadError; } // Why the last loadFile failed; empty after a success
     
     // Public access to engine for UI
     GranularEngine engine;
@@ -57,17 +80,30 @@ public:
 private:
 
     juce::AudioFormatManager formats;
-    std::unique_ptr<juce::AudioBuffer<float>> sampleBuffer;
+    int pyramidBudgetMB = 128;
+    int sourceFormat = grainSampleFloat32;
+    
+    // Samples larger than this decoded stream from disk through a cache of streamCacheMB
+    static constexpr int streamingThresholdMB = 512;
+    static constexpr int streamCacheMB = 256;
+    
+    // Decodes samples and builds their pyramids in the background, then hands them to the audio thread
+    GrainSourceLoader sourceLoader;
 
     // FX
-    juce::Reverb reverb;
-    juce::Reverb::Parameters reverbParams;
-    juce::dsp::DelayLine<float> delay { 48000 }; // 1s max at 48k
-    float delayFeedback = 0.5f;
+    EffectsChain effects;
+    
+    // Silence tracking: once the voices stop, the FX ring out for effectsTailSamples, then processBlock idles
+    int effectsTailSamples = 0;
+    bool idle = false;
+    QualityGovernor governor;
+    PerformanceTelemetry telemetry;
 
     bool noteGate = false;
     double fileSampleRate = 44100.0;
+    double sourceTargetRate = 0.0; // Session rate the loaded sample was converted to (0 before the first prepareToPlay)
     juce::String currentSamplePath;
+    juce::String sampleLoadError;
 
     // Fallback tone + metering
     float tonePhase = 0.0f;
@@ -78,7 +114,23 @@ private:
     std::atomic<int> lastMidiVel  { -1 };
     std::atomic<int> lastMidiChan { -1 };
 
+    // Parameter values cached at construction: no string lookups on the audio thread
+    struct EngineParamBinding {
+        std::atomic<float>* value;
+        float GranularEngine::Params::* field;
+    };
+    std::vector<EngineParamBinding> engineParamBindings;
+    std::atomic<float>* qualityParam = nullptr;
+    std::atomic<float>* multiCoreParam = nullptr;
+    std::atomic<float>* grainBudgetParam = nullptr;
+    std::atomic<float>* adaptiveParam = nullptr;
+    std::atomic<float>* testToneParam = nullptr;
+    std::atomic<float>* levelParam = nullptr;
+    std::atomic<float>* delayMixParam = nullptr;
+    std::atomic<float>* reverbMixParam = nullptr;
+
     void updateFromParams();
+    double getEffectsTailSeconds() const;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Dkash47GranularSynthAudioProcessor)
 };
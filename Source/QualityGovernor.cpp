@@ -0,0 +1,75 @@
+#include "QualityGovernor.h"
+
+void QualityGovernor::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    holdSamples = (int)(holdSeconds * sampleRate);
+    reset();
+}
+
+void QualityGovernor::reset()
+{
+    load = 0.0;
+    holdRemaining = 0;
+    level.store(0, std::memory_order_relaxed);
+    smoothedLoad.store(0.0f, std::memory_order_relaxed);
+}
+
+void QualityGovernor::update(double renderSeconds, int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+        
+    const double blockSeconds = numSamples / sampleRate;
+    
+    // Time-based smoothing, so the response doesn't depend on the block size
+    const double alpha = 1.0 - std::exp(-blockSeconds / loadTimeConstant);
+    load += alpha * (renderSeconds / blockSeconds - load);
+    smoothedLoad.store((float)load, std::memory_order_relaxed);
+    
+    if (holdRemaining > 0)
+    {
+        holdRemaining -= numSamples;
+        return;
+    }
+    
+    const int current = getLevel();
+    int next = current;
+    if (load > highLoad && current < numLevels - 1)
+        next = current + 1;
+    else if (load < lowLoad && current > 0)
+        next = current - 1;
+        
+    if (next != current)
+    {
+        level.store(next, std::memory_order_relaxed);
+        holdRemaining = holdSamples;
+    }
+}
+
+void QualityGovernor::apply(GranularEngine::Params& params, int& grainBudget) const
+{
+    const int current = getLevel();
+    if (current == 0)
+        return;
+        
+    // "No limit" degrades from the largest finite budget
+    const int fullBudget = grainBudget > 0 ? grainBudget : 256;
+    
+    if (current >= 1)
+        params.quality = juce::jmin(params.quality, 1.0f);
+        
+    if (current >= 2)
+    {
+        params.unisonVoices = juce::jmin(params.unisonVoices, 2.0f);
+        grainBudget = juce::jmax(16, fullBudget / 2);
+    }
+    
+    if (current >= 3)
+    {
+        params.quality = 0.0f;
+        params.unisonVoices = 1.0f;
+        params.chorusAmount = 0.0f;
+        grainBudget = juce::jmax(16, fullBudget / 4);
+    }
+}
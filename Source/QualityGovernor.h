@@ -0,0 +1,42 @@
+#pragma once
+#include <JuceHeader.h>
+#include "GranularEngine.h"
+
+// Closed-loop quality control from measured render time
+// The processor reports how long each block took against its real-time
+// deadline. The governor smooths that load and steps through degradation
+// levels, cheapest to hear first: sinc interpolation drops to cubic, then
+// unison and the grain budget shrink, then linear interpolation with no chorus.
+// It degrades above highLoad and restores below lowLoad, and holds each level
+// for a while after a change, so it settles instead of oscillating.
+class QualityGovernor {
+public:
+    static constexpr int numLevels = 4; // 0 = full quality
+    
+    void prepare(double sampleRate);
+    void reset();
+    
+    // Audio thread, once per block
+    void update(double renderSeconds, int numSamples);
+    
+    // Caps the snapshot and budget for the current level
+    void apply(GranularEngine::Params& params, int& grainBudget) const;
+    
+    // Safe from any thread
+    int getLevel() const { return level.load(std::memory_order_relaxed); }
+    float getLoad() const { return smoothedLoad.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr double highLoad = 0.75;    // Fraction of the block deadline
+    static constexpr double lowLoad = 0.45;
+    static constexpr double loadTimeConstant = 0.3; // Seconds
+    static constexpr double holdSeconds = 0.5;
+    
+    double sampleRate = 44100.0;
+    double load = 0.0;
+    int holdSamples = 0;
+    int holdRemaining = 0;
+    
+    std::atomic<int> level { 0 };
+    std::atomic<float> smoothedLoad { 0.0f };
+};
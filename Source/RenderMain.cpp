@@ -0,0 +1,218 @@
+#include <JuceHeader.h>
+#include "OfflineRenderer.h"
+#include "GoldenScenarios.h"
+
+// Headless renderer: sample + saved plugin state + MIDI file -> WAV, with a timing report
+// Links the engine and effects only (no plugin wrapper or GUI modules), so it
+// runs on build machines without a host and profiles cleanly under perf. With
+// --golden it instead checks the fixed scenarios against reference renders, and with
+// --kernels the vector grain kernels against the scalar ones.
+
+namespace {
+    const char* const usage =
+        "--preset=<state.xml> --midi=<file.mid> --out=<file.wav> [--sample=<file>]\n"
+        "    [--rate=48000] [--block=512] [--seed=1] [--quality=0|1|2|state] [--format=float|int16|half]\n"
+        "    [--bits=16|24|32] [--tail=<seconds>] [--parallel]";
+    
+    const char* const goldenUsage =
+        "--golden=<directory> [--update] [--filter=<text>] [--tolerance=0.0001] [--budget-scale=1]";
+    
+    int getIntOption(const juce::ArgumentList& args, const char* option, int defaultValue)
+    {
+        return args.containsOption(option) ? args.getValueForOption(option).getIntValue() : defaultValue;
+    }
+    
+    GrainSampleFormat getSampleFormat(const juce::ArgumentList& args)
+    {
+        const auto name = args.getValueForOption("--format");
+        if (name == "int16") return grainSampleInt16;
+        if (name == "half")  return grainSampleFloat16;
+        if (name.isEmpty() || name == "float") return grainSampleFloat32;
+        juce::ConsoleApplication::fail("Unknown sample format " + name);
+        return grainSampleFloat32;
+    }
+    
+    void printTiming(const OfflineRenderer::Timing& timing, double sampleRate)
+    {
+        const double deadline = (double)timing.blockSize / sampleRate;
+        auto describe = [deadline](double seconds) {
+            return juce::String(seconds * 1000.0, 3) + " ms (" + juce::String(seconds / deadline * 100.0, 1) + "% of deadline)";
+        };
+        
+        std::cout << "Rendered " << juce::String(timing.audioSeconds, 2) << " s in " << juce::String(timing.renderSeconds, 3)
+                  << " s: " << juce::String(timing.getRealtimeFactor(), 1) << "x realtime\n"
+                  << (int)timing.blockSeconds.size() << " blocks of " << timing.blockSize << " samples, deadline "
+                  << juce::String(deadline * 1000.0, 3) << " ms\n"
+                  << "  mean " << describe(timing.getMeanBlockSeconds()) << "\n"
+                  << "  p99  " << describe(timing.getBlockPercentile(99.0)) << "\n"
+                  << "  max  " << describe(timing.getMaxBlockSeconds()) << "\n"
+                  << "Kernels: " << GrainKernels::getInstructionSetName(GrainKernels::getInstructionSet()) << std::endl;
+    }
+    
+    void render(const juce::ArgumentList& args)
+    {
+        OfflineRenderer::Settings settings;
+        settings.sampleRate = args.containsOption("--rate") ? args.getValueForOption("--rate").getDoubleValue() : settings.sampleRate;
+        settings.blockSize = getIntOption(args, "--block", settings.blockSize);
+        settings.seed = getIntOption(args, "--seed", settings.seed);
+        settings.quality = args.getValueForOption("--quality") == "state" ? -1 : getIntOption(args, "--quality", settings.quality);
+        settings.sampleFormat = getSampleFormat(args);
+        settings.parallel = args.containsOption("--parallel");
+        if (args.containsOption("--tail"))
+            settings.tailSeconds = args.getValueForOption("--tail").getDoubleValue();
+        
+        if (settings.sampleRate < 8000.0 || settings.sampleRate > 384000.0)
+            juce::ConsoleApplication::fail("Sample rate out of range");
+        if (settings.blockSize < 1 || settings.blockSize > 16384)
+            juce::ConsoleApplication::fail("Block size out of range");
+        
+        OfflineRenderer renderer (settings);
+        auto check = [](const juce::Result& result) {
+            if (result.failed())
+                juce::ConsoleApplication::fail(result.getErrorMessage());
+        };
+        
+        check(renderer.loadState(args.getExistingFileForOption("--preset")));
+        for (const auto& warning : renderer.getStateWarnings())
+            std::cerr << "Warning: " << warning << std::endl;
+        
+        // The sample defaults to the one the state was saved with
+        const auto sampleFile = args.containsOption("--sample") ? args.getExistingFileForOption("--sample")
+                                                                : juce::File(renderer.getStateSamplePath());
+        if (!sampleFile.existsAsFile())
+            juce::ConsoleApplication::fail("No sample: pass --sample");
+        check(renderer.loadSample(sampleFile));
+        
+        juce::MidiMessageSequence events;
+        check(OfflineRenderer::readMidiFile(args.getExistingFileForOption("--midi"), events));
+        
+        juce::AudioBuffer<float> output;
+        const auto timing = renderer.render(events, output);
+        check(OfflineRenderer::writeWavFile(args.getFileForOption("--out"), output, settings.sampleRate, getIntOption(args, "--bits", 24)));
+        printTiming(timing, settings.sampleRate);
+    }
+    
+    // Measures every vector path the CPU supports against the scalar reference; fails
+    // if any deviates by more than GrainKernels::maxDeviationFromScalar
+    void checkKernels(const juce::ArgumentList&)
+    {
+        GrainKernels::initialise();
+        
+        int numFailed = 0;
+        for (auto set : { GrainKernels::InstructionSet::scalar, GrainKernels::InstructionSet::sse2,
+                          GrainKernels::InstructionSet::avx2, GrainKernels::InstructionSet::neon })
+        {
+            const juce::String name = GrainKernels::getInstructionSetName(set);
+            if (!GrainKernels::isAvailable(set))
+            {
+                std::cout << "  skip  " << name.paddedRight(' ', 10) << " not available" << std::endl;
+                continue;
+            }
+            
+            const float deviation = GrainKernels::measureDeviationFromScalar(set);
+            const bool ok = deviation <= GrainKernels::maxDeviationFromScalar;
+            std::cout << (ok ? "  ok    " : "  FAIL  ") << name.paddedRight(' ', 10)
+                      << " max deviation " << juce::String(deviation, 8) << std::endl;
+            numFailed += ok ? 0 : 1;
+        }
+        
+        if (numFailed > 0)
+            juce::ConsoleApplication::fail(juce::String(numFailed) + " kernel paths deviate from the scalar reference by more than "
+                                           + juce::String(GrainKernels::maxDeviationFromScalar));
+    }
+    
+    // Renders every scenario; fails if any differs from its reference by more than the
+    // tolerance, matches the scenario it must differ from, or runs over its CPU budget.
+    // --update rewrites the references (budgets and differences are still checked).
+    void checkGolden(const juce::ArgumentList& args)
+    {
+        const auto directory = args.getFileForOption("--golden");
+        const bool update = args.containsOption("--update");
+        const auto filter = args.getValueForOption("--filter");
+        const float tolerance = args.containsOption("--tolerance") ? args.getValueForOption("--tolerance").getFloatValue() : 1.0e-4f;
+        const double budgetScale = args.containsOption("--budget-scale") ? args.getValueForOption("--budget-scale").getDoubleValue() : 1.0;
+        
+        if (update && !directory.createDirectory())
+            juce::ConsoleApplication::fail("Can't create " + directory.getFullPathName());
+        if (!update && !directory.isDirectory())
+            juce::ConsoleApplication::fail("No references in " + directory.getFullPathName() + " (see golden/README.md)");
+            
+        OfflineRenderer::Settings settings;
+        settings.sampleRate = GoldenScenarios::sampleRate;
+        settings.blockSize = GoldenScenarios::blockSize;
+        settings.quality = -1; // Each scenario sets its own
+        settings.tailSeconds = GoldenScenarios::tailSeconds;
+        
+        const auto phrase = GoldenScenarios::makePhrase();
+        const auto sourceAudio = GoldenScenarios::makeSource();
+        std::map<juce::String, juce::AudioBuffer<float>> outputs;
+        int numChecked = 0, numFailed = 0;
+        
+        for (const auto& scenario : GoldenScenarios::make())
+        {
+            if (filter.isNotEmpty() && !scenario.name.contains(filter))
+                continue;
+                
+            // A fresh renderer each time, so nothing carries over between scenarios
+            OfflineRenderer renderer (settings);
+            renderer.loadSample(sourceAudio, GoldenScenarios::sampleRate);
+            renderer.setParams(scenario.params);
+            
+            juce::AudioBuffer<float> output;
+            const auto timing = renderer.render(phrase, output);
+            const double cpu = timing.renderSeconds / timing.audioSeconds;
+            
+            juce::StringArray problems;
+            if (cpu > scenario.cpuBudget * budgetScale)
+                problems.add("over CPU budget of " + juce::String(scenario.cpuBudget * budgetScale * 100.0, 1) + "%");
+                
+            const auto other = outputs.find(scenario.mustDifferFrom);
+            if (other != outputs.end() && GoldenScenarios::getMaxDifference(output, other->second) <= tolerance)
+                problems.add("sounds the same as " + scenario.mustDifferFrom);
+                
+            const auto file = directory.getChildFile(scenario.name + ".wav");
+            float difference = 0.0f;
+            if (update)
+            {
+                const auto result = OfflineRenderer::writeWavFile(file, output, settings.sampleRate, 32);
+                if (result.failed())
+                    problems.add(result.getErrorMessage());
+            }
+            else
+            {
+                juce::AudioBuffer<float> reference;
+                const auto result = OfflineRenderer::readWavFile(file, reference);
+                difference = result.wasOk() ? GoldenScenarios::getMaxDifference(output, reference) : 0.0f;
+                if (result.failed())
+                    problems.add(result.getErrorMessage());
+                else if (difference > tolerance)
+                    problems.add("differs from the reference by " + juce::String(difference, 6));
+            }
+            
+            std::cout << (problems.size() == 0 ? "  ok    " : "  FAIL  ") << scenario.name.paddedRight(' ', 16)
+                      << " CPU " << juce::String(cpu * 100.0, 2) << "%, max difference " << juce::String(difference, 6);
+            if (problems.size() > 0)
+                std::cout << ": " << problems.joinIntoString("; ");
+            std::cout << std::endl;
+            
+            ++numChecked;
+            numFailed += problems.size() > 0 ? 1 : 0;
+            outputs[scenario.name] = std::move(output);
+        }
+        
+        std::cout << "Kernels: " << GrainKernels::getInstructionSetName(GrainKernels::getInstructionSet()) << std::endl;
+        if (numFailed > 0)
+            juce::ConsoleApplication::fail(juce::String(numFailed) + " of " + juce::String(numChecked) + " scenarios failed");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ConsoleApplication app;
+    app.addHelpCommand("--help|-h", juce::String("Usage: granular-render ") + usage + "\n   or: granular-render " + goldenUsage
+                       + "\n   or: granular-render --kernels", false);
+    app.addCommand({ "--golden", goldenUsage, "Checks the engine against reference renders", {}, checkGolden });
+    app.addCommand({ "--kernels", "--kernels", "Checks every available kernel path against the scalar reference", {}, checkKernels });
+    app.addDefaultCommand({ "", usage, "Renders a MIDI file through the granular engine", {}, render });
+    return app.findAndRunCommand(argc, argv);
+}